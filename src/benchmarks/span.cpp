@@ -0,0 +1,104 @@
+// Copyright (C) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Memory used by splitting an in-memory archive into per-entry sub-spans,
+// the way hashfs::parse does.
+// usage: span-bench [archive MiB = 1024] [entries = 200000]
+
+#include "util/span.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+
+// peak resident memory of the process in bytes
+size_t peak_rss()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+double mib(size_t bytes)
+{
+    return bytes / (1024.0 * 1024.0);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    using namespace ssharp::types;
+    size_t archive_size = (argc > 1 ? std::stoull(argv[1]) : 1024) << 20;
+    size_t entries = argc > 2 ? std::stoull(argv[2]) : 200000;
+
+    auto before = peak_rss();
+    buff_t buff(archive_size);
+    for (size_t i = 0; i < buff.size(); i += 4096)
+    {
+        buff[i] = static_cast<uint8_t>(i >> 12);
+    }
+    ssharp::util::span_t archive{std::move(buff)};
+    auto loaded = peak_rss();
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<ssharp::util::span_t> spans;
+    spans.reserve(entries);
+    auto entry_size = archive_size / entries;
+    for (size_t i = 0; i < entries; i++)
+    {
+        spans.emplace_back(archive,
+                           span_attr_t{static_cast<pos_t>(i * entry_size),
+                                       entry_size});
+    }
+    // copies, as the entry table and its consumers make them
+    auto copies = spans;
+    auto elapsed = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start);
+    auto split = peak_rss();
+
+    size_t checksum = 0;
+    for (const auto& span : copies)
+    {
+        checksum += (*span.view())[0];
+    }
+    std::printf("archive:   %.1f MiB, %zu entries of %zu bytes\n",
+                mib(archive_size), entries, entry_size);
+    std::printf("loaded:    +%.1f MiB peak resident\n", mib(loaded - before));
+    std::printf("sub-spans: +%.1f MiB peak resident, %.1f ms for %zu spans "
+                "and as many copies (%zu)\n",
+                mib(split - loaded), elapsed.count(), entries, checksum);
+    return 0;
+}
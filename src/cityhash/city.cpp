@@ -61,6 +61,17 @@
 // compromising on hash quality.
 
 #include "city.hpp"
+#include "city_batch.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef CITYHASH_HAVE_X86_SIMD
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+#endif
 
 namespace cityhash
 {
@@ -288,4 +299,194 @@ uint64_t CityHash64(const std::string& s)
     return CityHash64(s.data(), s.size());
 }
 
+// Writes salt in decimal to out, returns the number of digits.
+static size_t FormatSalt(uint16_t salt, char* out)
+{
+    char digits[5];
+    size_t n = 0;
+    do
+    {
+        digits[n++] = static_cast<char>('0' + salt % 10);
+        salt /= 10;
+    } while (salt != 0);
+    for (size_t i = 0; i < n; i++)
+    {
+        out[i] = digits[n - 1 - i];
+    }
+    return n;
+}
+
+static constexpr size_t kSaltedStackSize = 1024;
+
+uint64_t CityHash64Salted(uint16_t salt, std::string_view s)
+{
+    if (salt == 0)
+    {
+        return CityHash64(s.data(), s.size());
+    }
+    char stack[kSaltedStackSize];
+    std::string heap;
+    char* buf = stack;
+    if (s.size() + 5 > sizeof(stack))
+    {
+        heap.resize(s.size() + 5);
+        buf = heap.data();
+    }
+    size_t n = FormatSalt(salt, buf);
+    memcpy(buf + n, s.data(), s.size());
+    return CityHash64(buf, n + s.size());
+}
+
+// The widest batch kernels this CPU can run, nullptr for scalar only.
+static const detail::BatchKernels* BatchKernels()
+{
+#ifdef CITYHASH_HAVE_X86_SIMD
+    static const detail::BatchKernels* kernels = []() {
+        bool avx2 = false;
+        bool avx512 = false;
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 1);
+        bool osxsave = info[2] & (1 << 27);
+        uint64_t xcr0 = osxsave ? _xgetbv(0) : 0;
+        __cpuidex(info, 7, 0);
+        // the OS must save the ymm and zmm state
+        avx2 = (xcr0 & 0x06) == 0x06 && (info[1] & (1 << 5));
+        avx512 = (xcr0 & 0xe6) == 0xe6 && (info[1] & (1 << 16)) &&
+                 (info[1] & (1 << 17));
+#else
+        __builtin_cpu_init();
+        avx2 = __builtin_cpu_supports("avx2");
+        avx512 = __builtin_cpu_supports("avx512f") &&
+                 __builtin_cpu_supports("avx512dq");
+#endif
+        return avx512 ? &detail::kAvx512Kernels
+               : avx2 ? &detail::kAvx2Kernels
+                      : nullptr;
+    }();
+    return kernels;
+#else
+    return nullptr;
+#endif
+}
+
+void CityHash64(std::span<const std::string_view> strs,
+                std::span<uint64_t> out)
+{
+    const auto* kernels = BatchKernels();
+    if (kernels == nullptr)
+    {
+        for (size_t i = 0; i < strs.size(); i++)
+        {
+            out[i] = CityHash64(strs[i].data(), strs[i].size());
+        }
+        return;
+    }
+
+    // Sort each block by length class so every kernel call only sees
+    // strings taking the same branch.
+    constexpr size_t kBlock = 128;
+    const char* ptrs[5][kBlock];
+    size_t lens[5][kBlock];
+    uint16_t index[5][kBlock];
+    uint64_t hashes[kBlock];
+    for (size_t base = 0; base < strs.size(); base += kBlock)
+    {
+        size_t n = std::min(kBlock, strs.size() - base);
+        size_t fill[5] = {};
+        for (size_t i = 0; i < n; i++)
+        {
+            const auto& str = strs[base + i];
+            size_t len = str.size();
+            if (len == 0 || len > 64)
+            {
+                out[base + i] = CityHash64(str.data(), len);
+                continue;
+            }
+            size_t bucket = len <= 3    ? 0
+                            : len <= 8  ? 1
+                            : len <= 16 ? 2
+                            : len <= 32 ? 3
+                                        : 4;
+            ptrs[bucket][fill[bucket]] = str.data();
+            lens[bucket][fill[bucket]] = len;
+            index[bucket][fill[bucket]] = static_cast<uint16_t>(i);
+            fill[bucket]++;
+        }
+        for (size_t bucket = 0; bucket < 5; bucket++)
+        {
+            if (fill[bucket] == 0)
+            {
+                continue;
+            }
+            if (kernels->kernels[bucket] == nullptr)
+            {
+                for (size_t j = 0; j < fill[bucket]; j++)
+                {
+                    hashes[j] = CityHash64(ptrs[bucket][j], lens[bucket][j]);
+                }
+            }
+            else
+            {
+                kernels->kernels[bucket](ptrs[bucket], lens[bucket],
+                                         fill[bucket], hashes);
+            }
+            for (size_t j = 0; j < fill[bucket]; j++)
+            {
+                out[base + index[bucket][j]] = hashes[j];
+            }
+        }
+    }
+}
+
+void CityHash64Salted(uint16_t salt, std::span<const std::string_view> strs,
+                      std::span<uint64_t> out)
+{
+    if (salt == 0)
+    {
+        CityHash64(strs, out);
+        return;
+    }
+    // Salt a block of strings into one stack arena and hash it as a batch,
+    // strings that do not fit are hashed one by one.
+    constexpr size_t kBlock = 128;
+    char arena[16 * 1024];
+    std::string_view salted[kBlock];
+    size_t index[kBlock];
+    char prefix[5];
+    size_t prefix_len = FormatSalt(salt, prefix);
+    size_t i = 0;
+    while (i < strs.size())
+    {
+        size_t used = 0;
+        size_t n = 0;
+        for (; i < strs.size() && n < kBlock; i++)
+        {
+            const auto& str = strs[i];
+            if (prefix_len + str.size() > sizeof(arena) - used)
+            {
+                if (n != 0)
+                {
+                    break;
+                }
+                out[i] = CityHash64Salted(salt, str);
+                continue;
+            }
+            char* dst = arena + used;
+            memcpy(dst, prefix, prefix_len);
+            memcpy(dst + prefix_len, str.data(), str.size());
+            used += prefix_len + str.size();
+            salted[n] = std::string_view(dst, prefix_len + str.size());
+            index[n++] = i;
+        }
+        uint64_t hashes[kBlock];
+        CityHash64(std::span<const std::string_view>(salted, n),
+                   std::span<uint64_t>(hashes, n));
+        for (size_t j = 0; j < n; j++)
+        {
+            out[index[j]] = hashes[j];
+        }
+    }
+}
+
 } // namespace cityhash
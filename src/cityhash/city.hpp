@@ -20,6 +20,9 @@
 // - Removed BigEndian support (please create an issue if you need it)
 // - Tidied up with clang-format and migrated coding style to C++23
 // - Added std::string overloads for convenience
+// - Added a batch overload with AVX2/AVX-512 multi-buffer kernels
+// - Added salted overloads matching how SCS salts hashfs path hashes
+// - Added constexpr versions in city_constexpr.hpp
 // - Added license header
 //
 // The Modified code is licensed under the Apache License, Version 2.0
@@ -95,7 +98,9 @@
 #pragma once
 
 #include <cstdint>
+#include <span>
 #include <string>
+#include <string_view>
 
 namespace cityhash
 {
@@ -106,4 +111,20 @@ uint64_t CityHash64(const std::string& s);
 // Hash function for a byte array.
 uint64_t CityHash64(const char* buf, size_t len);
 
+// Hash function for many strings, out[i] = CityHash64(strs[i]).
+// Strings of up to 64 bytes are hashed several at a time with AVX2 or
+// AVX-512 when the CPU has them, with results identical to the scalar
+// code. out must be at least as long as strs.
+void CityHash64(std::span<const std::string_view> strs,
+                std::span<uint64_t> out);
+
+// Hash function for a salted string: the hash of the salt in decimal
+// followed by s, or of s alone for salt 0. Strings of up to 1 KiB are
+// salted in a stack buffer, nothing is allocated.
+uint64_t CityHash64Salted(uint16_t salt, std::string_view s);
+
+// Batch form of CityHash64Salted with the same kernels as CityHash64.
+void CityHash64Salted(uint16_t salt, std::span<const std::string_view> strs,
+                      std::span<uint64_t> out);
+
 } // namespace cityhash
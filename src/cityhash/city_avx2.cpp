@@ -0,0 +1,109 @@
+// city_avx2.cpp
+// Cityhash for ssharp
+// Copyright (c) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0, see city.hpp.
+//
+// AVX2 batch kernels, four strings per call. Compiled with AVX2 enabled,
+// only reached when the CPU supports it.
+
+#include "city_simd.hpp"
+
+#include <immintrin.h>
+
+namespace cityhash::detail
+{
+namespace
+{
+
+struct Avx2
+{
+    using Reg = __m256i;
+    static constexpr size_t lanes = 4;
+
+    template <typename F>
+    static Reg Gather(F&& f)
+    {
+        return _mm256_set_epi64x(static_cast<long long>(f(3)),
+                                 static_cast<long long>(f(2)),
+                                 static_cast<long long>(f(1)),
+                                 static_cast<long long>(f(0)));
+    }
+    static Reg Load(const void* p)
+    {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+    // the masked gathers start from zero instead of an undefined register
+    static Reg Fetch64(Reg p)
+    {
+        return _mm256_mask_i64gather_epi64(_mm256_setzero_si256(), nullptr, p,
+                                           _mm256_set1_epi64x(-1), 1);
+    }
+    static Reg Fetch32(Reg p)
+    {
+        return _mm256_cvtepu32_epi64(_mm256_mask_i64gather_epi32(
+            _mm_setzero_si128(), nullptr, p, _mm_set1_epi32(-1), 1));
+    }
+    static Reg Set1(uint64_t x)
+    {
+        return _mm256_set1_epi64x(static_cast<long long>(x));
+    }
+    static void Store(uint64_t* p, Reg v)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+    }
+    static Reg Add(Reg a, Reg b)
+    {
+        return _mm256_add_epi64(a, b);
+    }
+    static Reg Sub(Reg a, Reg b)
+    {
+        return _mm256_sub_epi64(a, b);
+    }
+    static Reg Xor(Reg a, Reg b)
+    {
+        return _mm256_xor_si256(a, b);
+    }
+    // AVX2 has no 64-bit multiply, build it from 32x32->64 products
+    static Reg Mul(Reg a, Reg b)
+    {
+        Reg lo = _mm256_mul_epu32(a, b);
+        Reg cross = _mm256_add_epi64(
+            _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+            _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+        return _mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32));
+    }
+    template <int n>
+    static Reg Shl(Reg v)
+    {
+        return _mm256_slli_epi64(v, n);
+    }
+    template <int n>
+    static Reg Shr(Reg v)
+    {
+        return _mm256_srli_epi64(v, n);
+    }
+    template <int n>
+    static Reg Rotate(Reg v)
+    {
+        return _mm256_or_si256(_mm256_srli_epi64(v, n),
+                               _mm256_slli_epi64(v, 64 - n));
+    }
+    static Reg RotateV(Reg v, Reg n)
+    {
+        return _mm256_or_si256(
+            _mm256_srlv_epi64(v, n),
+            _mm256_sllv_epi64(v, _mm256_sub_epi64(Set1(64), n)));
+    }
+};
+
+} // namespace
+
+// 33 to 64 bytes measured slower than the scalar code, eight gathers and
+// a dozen emulated multiplies per group, so that class stays in city.cpp.
+const BatchKernels kAvx2Kernels = []() {
+    auto kernels = MakeKernels<Avx2>();
+    kernels.kernels[4] = nullptr;
+    return kernels;
+}();
+
+} // namespace cityhash::detail
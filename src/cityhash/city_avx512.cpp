@@ -0,0 +1,96 @@
+// city_avx512.cpp
+// Cityhash for ssharp
+// Copyright (c) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0, see city.hpp.
+//
+// AVX-512 batch kernels, eight strings per call. Compiled with AVX-512F and
+// AVX-512DQ enabled, only reached when the CPU and OS support both.
+
+#include "city_simd.hpp"
+
+#include <immintrin.h>
+
+namespace cityhash::detail
+{
+namespace
+{
+
+struct Avx512
+{
+    using Reg = __m512i;
+    static constexpr size_t lanes = 8;
+
+    template <typename F>
+    static Reg Gather(F&& f)
+    {
+        return _mm512_set_epi64(
+            static_cast<long long>(f(7)), static_cast<long long>(f(6)),
+            static_cast<long long>(f(5)), static_cast<long long>(f(4)),
+            static_cast<long long>(f(3)), static_cast<long long>(f(2)),
+            static_cast<long long>(f(1)), static_cast<long long>(f(0)));
+    }
+    static Reg Load(const void* p)
+    {
+        return _mm512_loadu_si512(p);
+    }
+    // the masked gathers start from zero instead of an undefined register
+    static Reg Fetch64(Reg p)
+    {
+        return _mm512_mask_i64gather_epi64(_mm512_setzero_si512(), 0xFF, p,
+                                           nullptr, 1);
+    }
+    static Reg Fetch32(Reg p)
+    {
+        return _mm512_cvtepu32_epi64(_mm512_mask_i64gather_epi32(
+            _mm256_setzero_si256(), 0xFF, p, nullptr, 1));
+    }
+    static Reg Set1(uint64_t x)
+    {
+        return _mm512_set1_epi64(static_cast<long long>(x));
+    }
+    static void Store(uint64_t* p, Reg v)
+    {
+        _mm512_storeu_si512(p, v);
+    }
+    static Reg Add(Reg a, Reg b)
+    {
+        return _mm512_add_epi64(a, b);
+    }
+    static Reg Sub(Reg a, Reg b)
+    {
+        return _mm512_sub_epi64(a, b);
+    }
+    static Reg Xor(Reg a, Reg b)
+    {
+        return _mm512_xor_si512(a, b);
+    }
+    static Reg Mul(Reg a, Reg b)
+    {
+        return _mm512_mullo_epi64(a, b);
+    }
+    template <int n>
+    static Reg Shl(Reg v)
+    {
+        return _mm512_slli_epi64(v, n);
+    }
+    template <int n>
+    static Reg Shr(Reg v)
+    {
+        return _mm512_srli_epi64(v, n);
+    }
+    template <int n>
+    static Reg Rotate(Reg v)
+    {
+        return _mm512_ror_epi64(v, n);
+    }
+    static Reg RotateV(Reg v, Reg n)
+    {
+        return _mm512_rorv_epi64(v, n);
+    }
+};
+
+} // namespace
+
+const BatchKernels kAvx512Kernels = MakeKernels<Avx512>();
+
+} // namespace cityhash::detail
@@ -0,0 +1,35 @@
+// city_batch.hpp
+// Cityhash for ssharp
+// Copyright (c) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0, see city.hpp.
+//
+// Multi-buffer kernels behind the batch CityHash64 overload. Each kernel
+// hashes n strings that all take the same branch of CityHash64, several at
+// a time, and is bit-for-bit identical to the scalar code in city.cpp.
+// The kernels live in their own translation units, compiled for their
+// instruction set, and are only called after a runtime CPU check.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace cityhash::detail
+{
+
+using BatchKernel = void (*)(const char* const* s, const size_t* len,
+                             size_t n, uint64_t* out);
+
+// One kernel per length class: 1-3, 4-8, 9-16, 17-32 and 33-64 bytes,
+// nullptr where the scalar code is faster.
+struct BatchKernels
+{
+    BatchKernel kernels[5];
+};
+
+#ifdef CITYHASH_HAVE_X86_SIMD
+extern const BatchKernels kAvx2Kernels;
+extern const BatchKernels kAvx512Kernels;
+#endif
+
+} // namespace cityhash::detail
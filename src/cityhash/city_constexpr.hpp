@@ -0,0 +1,221 @@
+// city_constexpr.hpp
+// Cityhash for ssharp
+// Copyright (c) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0, see city.hpp.
+//
+// CityHash64 v1.0.3 as constexpr functions, so hashes of path literals can
+// be computed by the compiler. The results are identical to city.cpp: the
+// only difference is that bytes are assembled one at a time instead of
+// with memcpy, which is not usable in constant expressions. At runtime
+// prefer city.hpp, this is the slow way to compute the same thing.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+namespace cityhash::constexpr_hash
+{
+
+namespace detail
+{
+
+inline constexpr uint64_t k0 = 0xc3a5c85c97cb3127ULL;
+inline constexpr uint64_t k1 = 0xb492b66fbe98f273ULL;
+inline constexpr uint64_t k2 = 0x9ae16a3b2f90404fULL;
+inline constexpr uint64_t k3 = 0xc949d7c7509e6557ULL;
+
+constexpr uint64_t Fetch64(const char* p)
+{
+    uint64_t result = 0;
+    for (int i = 7; i >= 0; i--)
+    {
+        result = (result << 8) | static_cast<uint8_t>(p[i]);
+    }
+    return result;
+}
+
+constexpr uint32_t Fetch32(const char* p)
+{
+    uint32_t result = 0;
+    for (int i = 3; i >= 0; i--)
+    {
+        result = (result << 8) | static_cast<uint8_t>(p[i]);
+    }
+    return result;
+}
+
+constexpr uint64_t Rotate(uint64_t val, int shift)
+{
+    return shift == 0 ? val : ((val >> shift) | (val << (64 - shift)));
+}
+
+constexpr uint64_t ShiftMix(uint64_t val)
+{
+    return val ^ (val >> 47);
+}
+
+constexpr uint64_t HashLen16(uint64_t u, uint64_t v)
+{
+    constexpr uint64_t kMul = 0x9ddfea08eb382d69ULL;
+    uint64_t a = (u ^ v) * kMul;
+    a ^= (a >> 47);
+    uint64_t b = (v ^ a) * kMul;
+    b ^= (b >> 47);
+    b *= kMul;
+    return b;
+}
+
+constexpr uint64_t HashLen0to16(const char* s, size_t len)
+{
+    if (len > 8)
+    {
+        uint64_t a = Fetch64(s);
+        uint64_t b = Fetch64(s + len - 8);
+        return HashLen16(a, Rotate(b + len, static_cast<int>(len))) ^ b;
+    }
+    if (len >= 4)
+    {
+        uint64_t a = Fetch32(s);
+        return HashLen16(len + (a << 3), Fetch32(s + len - 4));
+    }
+    if (len > 0)
+    {
+        uint8_t a = static_cast<uint8_t>(s[0]);
+        uint8_t b = static_cast<uint8_t>(s[len >> 1]);
+        uint8_t c = static_cast<uint8_t>(s[len - 1]);
+        uint32_t y = static_cast<uint32_t>(a) + (static_cast<uint32_t>(b) << 8);
+        uint32_t z = static_cast<uint32_t>(len) +
+                     (static_cast<uint32_t>(c) << 2);
+        return ShiftMix(y * k2 ^ z * k3) * k2;
+    }
+    return k2;
+}
+
+constexpr uint64_t HashLen17to32(const char* s, size_t len)
+{
+    uint64_t a = Fetch64(s) * k1;
+    uint64_t b = Fetch64(s + 8);
+    uint64_t c = Fetch64(s + len - 8) * k2;
+    uint64_t d = Fetch64(s + len - 16) * k0;
+    return HashLen16(Rotate(a - b, 43) + Rotate(c, 30) + d,
+                     a + Rotate(b ^ k3, 20) - c + len);
+}
+
+constexpr std::pair<uint64_t, uint64_t> WeakHashLen32WithSeeds(
+    const char* s, uint64_t a, uint64_t b)
+{
+    uint64_t w = Fetch64(s);
+    uint64_t x = Fetch64(s + 8);
+    uint64_t y = Fetch64(s + 16);
+    uint64_t z = Fetch64(s + 24);
+    a += w;
+    b = Rotate(b + a + z, 21);
+    uint64_t c = a;
+    a += x;
+    a += y;
+    b += Rotate(a, 44);
+    return {a + z, b + c};
+}
+
+constexpr uint64_t HashLen33to64(const char* s, size_t len)
+{
+    uint64_t z = Fetch64(s + 24);
+    uint64_t a = Fetch64(s) + (len + Fetch64(s + len - 16)) * k0;
+    uint64_t b = Rotate(a + z, 52);
+    uint64_t c = Rotate(a, 37);
+    a += Fetch64(s + 8);
+    c += Rotate(a, 7);
+    a += Fetch64(s + 16);
+    uint64_t vf = a + z;
+    uint64_t vs = b + Rotate(a, 31) + c;
+    a = Fetch64(s + 16) + Fetch64(s + len - 32);
+    z = Fetch64(s + len - 8);
+    b = Rotate(a + z, 52);
+    c = Rotate(a, 37);
+    a += Fetch64(s + len - 24);
+    c += Rotate(a, 7);
+    a += Fetch64(s + len - 16);
+    uint64_t wf = a + z;
+    uint64_t ws = b + Rotate(a, 31) + c;
+    uint64_t r = ShiftMix((vf + ws) * k2 + (wf + vs) * k0);
+    return ShiftMix(r * k0 + vs) * k2;
+}
+
+constexpr uint64_t CityHash64(const char* s, size_t len)
+{
+    if (len <= 16)
+    {
+        return HashLen0to16(s, len);
+    }
+    if (len <= 32)
+    {
+        return HashLen17to32(s, len);
+    }
+    if (len <= 64)
+    {
+        return HashLen33to64(s, len);
+    }
+
+    uint64_t x = Fetch64(s + len - 40);
+    uint64_t y = Fetch64(s + len - 16) + Fetch64(s + len - 56);
+    uint64_t z = HashLen16(Fetch64(s + len - 48) + len, Fetch64(s + len - 24));
+    auto v = WeakHashLen32WithSeeds(s + len - 64, len, z);
+    auto w = WeakHashLen32WithSeeds(s + len - 32, y + k1, x);
+    x = x * k1 + Fetch64(s);
+
+    len = (len - 1) & ~static_cast<size_t>(63);
+    do
+    {
+        x = Rotate(x + y + v.first + Fetch64(s + 8), 37) * k1;
+        y = Rotate(y + v.second + Fetch64(s + 48), 42) * k1;
+        x ^= w.second;
+        y += v.first + Fetch64(s + 40);
+        z = Rotate(z + w.first, 33) * k1;
+        v = WeakHashLen32WithSeeds(s, v.second * k1, x + w.first);
+        w = WeakHashLen32WithSeeds(s + 32, z + w.second, y + Fetch64(s + 16));
+        std::swap(z, x);
+        s += 64;
+        len -= 64;
+    } while (len != 0);
+    return HashLen16(HashLen16(v.first, w.first) + ShiftMix(y) * k1 + z,
+                     HashLen16(v.second, w.second) + x);
+}
+
+} // namespace detail
+
+// Same as cityhash::CityHash64.
+constexpr uint64_t CityHash64(std::string_view s)
+{
+    return detail::CityHash64(s.data(), s.size());
+}
+
+// Same as cityhash::CityHash64Salted, for literals only. Strings over 1 KiB
+// fail to compile.
+consteval uint64_t CityHash64Salted(uint16_t salt, std::string_view s)
+{
+    if (salt == 0)
+    {
+        return CityHash64(s);
+    }
+    char buf[5 + 1024]{};
+    size_t n = 0;
+    for (uint16_t rest = salt; rest != 0; rest /= 10)
+    {
+        n++;
+    }
+    for (size_t i = n, rest = salt; i > 0; i--, rest /= 10)
+    {
+        buf[i - 1] = static_cast<char>('0' + rest % 10);
+    }
+    if (s.size() > sizeof(buf) - n)
+    {
+        throw "CityHash64Salted: string too long for a constant expression";
+    }
+    s.copy(buf + n, s.size());
+    return detail::CityHash64(buf, n + s.size());
+}
+
+} // namespace cityhash::constexpr_hash
@@ -0,0 +1,207 @@
+// city_simd.hpp
+// Cityhash for ssharp
+// Copyright (c) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0, see city.hpp.
+//
+// The short-length branches of CityHash64 v1.0.3, written once over a
+// vector type V and instantiated by city_avx2.cpp and city_avx512.cpp.
+// Everything here has internal linkage on purpose: each instantiation is
+// compiled with its own instruction set and must never be merged with
+// another translation unit's copy.
+//
+// V provides:
+//   lanes               number of 64-bit lanes
+//   Gather(f)           vector of f(0) ... f(lanes - 1)
+//   Load(p)             lanes 64-bit values from p, unaligned
+//   Fetch64(p), Fetch32(p)  per-lane loads from the addresses in p, the
+//                       32-bit one zero-extended
+//   Set1(x), Store(p, v)
+//   Add, Sub, Xor, Mul  lane-wise 64-bit arithmetic, Mul keeps the low half
+//   Shl<n>, Shr<n>      shift by a constant
+//   Rotate<n>           rotate right by a constant
+//   RotateV(v, n)       rotate right by a per-lane amount
+
+#pragma once
+
+#include "city_batch.hpp"
+
+namespace cityhash::detail
+{
+namespace
+{
+
+constexpr uint64_t k0 = 0xc3a5c85c97cb3127ULL;
+constexpr uint64_t k1 = 0xb492b66fbe98f273ULL;
+constexpr uint64_t k2 = 0x9ae16a3b2f90404fULL;
+constexpr uint64_t k3 = 0xc949d7c7509e6557ULL;
+constexpr uint64_t kMul = 0x9ddfea08eb382d69ULL;
+
+template <typename V>
+typename V::Reg ShiftMix(typename V::Reg val)
+{
+    return V::Xor(val, V::template Shr<47>(val));
+}
+
+template <typename V>
+typename V::Reg HashLen16(typename V::Reg u, typename V::Reg v)
+{
+    auto mul = V::Set1(kMul);
+    auto a = V::Mul(V::Xor(u, v), mul);
+    a = ShiftMix<V>(a);
+    auto b = V::Mul(V::Xor(v, a), mul);
+    b = ShiftMix<V>(b);
+    return V::Mul(b, mul);
+}
+
+// Runs body on groups of V::lanes strings, a short last group is padded
+// with copies of its first string.
+template <typename V, typename Body>
+void ForEachGroup(const char* const* s, const size_t* len, size_t n,
+                  uint64_t* out, Body body)
+{
+    size_t i = 0;
+    for (; i + V::lanes <= n; i += V::lanes)
+    {
+        V::Store(out + i, body(s + i, len + i));
+    }
+    if (i == n)
+    {
+        return;
+    }
+    const char* gs[V::lanes];
+    size_t gl[V::lanes];
+    for (size_t j = 0; j < V::lanes; j++)
+    {
+        gs[j] = s[i + (i + j < n ? j : 0)];
+        gl[j] = len[i + (i + j < n ? j : 0)];
+    }
+    alignas(64) uint64_t result[V::lanes];
+    V::Store(result, body(gs, gl));
+    for (size_t j = 0; i + j < n; j++)
+    {
+        out[i + j] = result[j];
+    }
+}
+
+template <typename V>
+void HashLen1to3(const char* const* s, const size_t* len, size_t n,
+                 uint64_t* out)
+{
+    ForEachGroup<V>(s, len, n, out, [](const char* const* s, const size_t* len) {
+        auto y = V::Gather([&](size_t j) {
+            uint8_t a = static_cast<uint8_t>(s[j][0]);
+            uint8_t b = static_cast<uint8_t>(s[j][len[j] >> 1]);
+            return uint64_t{static_cast<uint32_t>(a) +
+                            (static_cast<uint32_t>(b) << 8)};
+        });
+        auto z = V::Gather([&](size_t j) {
+            uint8_t c = static_cast<uint8_t>(s[j][len[j] - 1]);
+            return uint64_t{static_cast<uint32_t>(len[j]) +
+                            (static_cast<uint32_t>(c) << 2)};
+        });
+        auto h = V::Xor(V::Mul(y, V::Set1(k2)), V::Mul(z, V::Set1(k3)));
+        return V::Mul(ShiftMix<V>(h), V::Set1(k2));
+    });
+}
+
+template <typename V>
+void HashLen4to8(const char* const* s, const size_t* len, size_t n,
+                 uint64_t* out)
+{
+    ForEachGroup<V>(s, len, n, out, [](const char* const* s, const size_t* len) {
+        auto p = V::Load(s);
+        auto l = V::Load(len);
+        auto a = V::Fetch32(p);
+        auto u = V::Add(l, V::template Shl<3>(a));
+        auto v = V::Fetch32(V::Sub(V::Add(p, l), V::Set1(4)));
+        return HashLen16<V>(u, v);
+    });
+}
+
+template <typename V>
+void HashLen9to16(const char* const* s, const size_t* len, size_t n,
+                  uint64_t* out)
+{
+    ForEachGroup<V>(s, len, n, out, [](const char* const* s, const size_t* len) {
+        auto p = V::Load(s);
+        auto l = V::Load(len);
+        auto a = V::Fetch64(p);
+        auto b = V::Fetch64(V::Sub(V::Add(p, l), V::Set1(8)));
+        return V::Xor(HashLen16<V>(a, V::RotateV(V::Add(b, l), l)), b);
+    });
+}
+
+template <typename V>
+void HashLen17to32(const char* const* s, const size_t* len, size_t n,
+                   uint64_t* out)
+{
+    ForEachGroup<V>(s, len, n, out, [](const char* const* s, const size_t* len) {
+        auto p = V::Load(s);
+        auto l = V::Load(len);
+        auto end = V::Add(p, l);
+        auto a = V::Mul(V::Fetch64(p), V::Set1(k1));
+        auto b = V::Fetch64(V::Add(p, V::Set1(8)));
+        auto c = V::Mul(V::Fetch64(V::Sub(end, V::Set1(8))), V::Set1(k2));
+        auto d = V::Mul(V::Fetch64(V::Sub(end, V::Set1(16))), V::Set1(k0));
+        auto u = V::Add(V::Add(V::template Rotate<43>(V::Sub(a, b)),
+                               V::template Rotate<30>(c)),
+                        d);
+        auto v = V::Add(
+            V::Sub(V::Add(a, V::template Rotate<20>(V::Xor(b, V::Set1(k3)))),
+                   c),
+            l);
+        return HashLen16<V>(u, v);
+    });
+}
+
+template <typename V>
+void HashLen33to64(const char* const* s, const size_t* len, size_t n,
+                   uint64_t* out)
+{
+    ForEachGroup<V>(s, len, n, out, [](const char* const* s, const size_t* len) {
+        auto p = V::Load(s);
+        auto l = V::Load(len);
+        auto end = V::Add(p, l);
+        auto fetch = [&](uint64_t offset) {
+            return V::Fetch64(V::Add(p, V::Set1(offset)));
+        };
+        auto fetch_end = [&](uint64_t back) {
+            return V::Fetch64(V::Sub(end, V::Set1(back)));
+        };
+        auto s16 = fetch(16);
+        auto e16 = fetch_end(16);
+
+        auto z = fetch(24);
+        auto a = V::Add(fetch(0), V::Mul(V::Add(l, e16), V::Set1(k0)));
+        auto b = V::template Rotate<52>(V::Add(a, z));
+        auto c = V::template Rotate<37>(a);
+        a = V::Add(a, fetch(8));
+        c = V::Add(c, V::template Rotate<7>(a));
+        a = V::Add(a, s16);
+        auto vf = V::Add(a, z);
+        auto vs = V::Add(V::Add(b, V::template Rotate<31>(a)), c);
+        a = V::Add(s16, fetch_end(32));
+        z = fetch_end(8);
+        b = V::template Rotate<52>(V::Add(a, z));
+        c = V::template Rotate<37>(a);
+        a = V::Add(a, fetch_end(24));
+        c = V::Add(c, V::template Rotate<7>(a));
+        a = V::Add(a, e16);
+        auto wf = V::Add(a, z);
+        auto ws = V::Add(V::Add(b, V::template Rotate<31>(a)), c);
+        auto r = ShiftMix<V>(V::Add(V::Mul(V::Add(vf, ws), V::Set1(k2)),
+                                    V::Mul(V::Add(wf, vs), V::Set1(k0))));
+        return V::Mul(ShiftMix<V>(V::Add(V::Mul(r, V::Set1(k0)), vs)),
+                      V::Set1(k2));
+    });
+}
+
+template <typename V>
+constexpr BatchKernels MakeKernels()
+{
+    return {{HashLen1to3<V>, HashLen4to8<V>, HashLen9to16<V>,
+             HashLen17to32<V>, HashLen33to64<V>}};
+}
+
+} // namespace
+} // namespace cityhash::detail
@@ -0,0 +1,174 @@
+// Copyright (C) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "checkpoint.hpp"
+
+#include "fs/resolver.hpp"
+#include "util/exceptions.hpp"
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace ssharp::fs::resolver
+{
+namespace ssexcept = ssharp::exceptions;
+
+void save_checkpoint(const checkpoint_t& checkpoint, const path_t& path)
+{
+    // a preempted run must never leave a half written checkpoint behind
+    auto temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream ofs(temporary, std::ios::binary);
+        if (!ofs)
+        {
+            throw std::ios::failure("failed to open file: " + temporary.string());
+        }
+        checkpoint_header_t header{checkpoint_signature,
+                                   checkpoint_version,
+                                   checkpoint.salt,
+                                   checkpoint.fingerprint,
+                                   checkpoint.range.begin,
+                                   checkpoint.range.end,
+                                   checkpoint.cursor,
+                                   static_cast<uint32_t>(checkpoint.pending.size()),
+                                   static_cast<uint32_t>(checkpoint.hits.size())};
+        ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        ofs.write(reinterpret_cast<const char*>(checkpoint.pending.data()),
+                  checkpoint.pending.size() * sizeof(hash_t));
+        for (const auto& [hash, hit] : checkpoint.hits)
+        {
+            auto length = static_cast<uint16_t>(hit.size());
+            ofs.write(reinterpret_cast<const char*>(&hash), sizeof(hash));
+            ofs.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            ofs.write(hit.data(), length);
+        }
+        if (!ofs.flush())
+        {
+            throw std::ios::failure("failed to write file: " + temporary.string());
+        }
+    }
+    std::filesystem::rename(temporary, path);
+}
+
+checkpoint_t load_checkpoint(const path_t& path)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs)
+    {
+        throw std::ios::failure("failed to open file: " + path.string());
+    }
+    checkpoint_header_t header{};
+    ifs.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!ifs || header.signature != checkpoint_signature)
+    {
+        throw ssexcept::parse_error("Invalid checkpoint file");
+    }
+    if (header.version != checkpoint_version)
+    {
+        throw ssexcept::parse_error("Unsupported checkpoint version");
+    }
+    std::error_code ec;
+    auto file_size = std::filesystem::file_size(path, ec);
+    if (ec)
+    {
+        throw std::ios::failure("failed to get file size: " + path.string());
+    }
+    // check the claimed count before allocating it, the header was read so
+    // the file is at least that long
+    if (header.pending_count > (file_size - sizeof(header)) / sizeof(hash_t))
+    {
+        throw ssexcept::parse_error("Truncated checkpoint file");
+    }
+    checkpoint_t checkpoint;
+    checkpoint.fingerprint = header.fingerprint;
+    checkpoint.salt = header.salt;
+    checkpoint.range = {header.begin, header.end};
+    checkpoint.cursor = header.cursor;
+    checkpoint.pending.resize(header.pending_count);
+    ifs.read(reinterpret_cast<char*>(checkpoint.pending.data()),
+             checkpoint.pending.size() * sizeof(hash_t));
+    for (uint32_t i = 0; i < header.hits_count && ifs; i++)
+    {
+        hash_t hash = 0;
+        uint16_t length = 0;
+        ifs.read(reinterpret_cast<char*>(&hash), sizeof(hash));
+        ifs.read(reinterpret_cast<char*>(&length), sizeof(length));
+        std::string hit(ifs ? length : 0, '\0');
+        ifs.read(hit.data(), hit.size());
+        checkpoint.hits.emplace_back(hash, std::move(hit));
+    }
+    if (!ifs || header.begin > header.cursor || header.cursor > header.end)
+    {
+        throw ssexcept::parse_error("Truncated checkpoint file");
+    }
+    return checkpoint;
+}
+
+checkpoint_t merge_checkpoints(std::span<const checkpoint_t> checkpoints)
+{
+    checkpoint_t merged;
+    if (checkpoints.empty())
+    {
+        return merged;
+    }
+    merged.fingerprint = checkpoints.front().fingerprint;
+    merged.salt = checkpoints.front().salt;
+    merged.range = checkpoints.front().range;
+    std::unordered_set<hash_t> found;
+    for (const auto& checkpoint : checkpoints)
+    {
+        if (checkpoint.fingerprint != merged.fingerprint ||
+            checkpoint.salt != merged.salt)
+        {
+            throw ssexcept::parse_error("Checkpoints are from different searches");
+        }
+        merged.range.begin = std::min(merged.range.begin, checkpoint.range.begin);
+        merged.range.end = std::max(merged.range.end, checkpoint.range.end);
+        for (const auto& hit : checkpoint.hits)
+        {
+            if (found.insert(hit.first).second)
+            {
+                merged.hits.push_back(hit);
+            }
+        }
+    }
+    // shards start from the same targets, those found by any are done
+    std::unordered_set<hash_t> pending;
+    for (const auto& checkpoint : checkpoints)
+    {
+        for (auto hash : checkpoint.pending)
+        {
+            if (!found.contains(hash) && pending.insert(hash).second)
+            {
+                merged.pending.push_back(hash);
+            }
+        }
+    }
+    // the merged cursor only means something when every shard is finished
+    auto finished = std::ranges::all_of(checkpoints, [](const checkpoint_t& c) {
+        return c.cursor == c.range.end;
+    });
+    merged.cursor = finished ? merged.range.end : merged.range.begin;
+    return merged;
+}
+
+range_t shard(uint64_t total, size_t index, size_t count)
+{
+    auto chunks = (total + chunk_size - 1) / chunk_size;
+    auto begin = chunks * index / count * chunk_size;
+    auto end = chunks * (index + 1) / count * chunk_size;
+    return {std::min(begin, total), std::min(end, total)};
+}
+
+} // namespace ssharp::fs::resolver
@@ -0,0 +1,103 @@
+// Copyright (C) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "util/types.hpp"
+
+#include <span>
+#include <string>
+#include <vector>
+
+namespace ssharp::fs::resolver
+{
+using namespace ssharp::types;
+
+constexpr uint32_t checkpoint_signature = 0x43525353U; // "SSRC"
+constexpr uint16_t checkpoint_version = 0x01;
+
+#pragma pack(push, 1)
+struct checkpoint_header_t
+{
+    uint32_t signature;
+    uint16_t version;
+    salt_t salt;
+    uint64_t fingerprint;
+    uint64_t begin;
+    uint64_t end;
+    uint64_t cursor;
+    uint32_t pending_count;
+    uint32_t hits_count;
+    // pending hashes (8 bytes each), then per hit the hash, a 16-bit
+    // length and the path
+};
+static_assert(sizeof(checkpoint_header_t) == 48,
+              "checkpoint_header_t size mismatch");
+#pragma pack(pop)
+
+/**
+ * @brief Half-open range of candidate numbers
+ */
+struct range_t
+{
+    uint64_t begin = 0;
+    uint64_t end = 0;
+
+    bool operator==(const range_t&) const = default;
+};
+
+/**
+ * @brief Where a search stands, enough to resume it
+ */
+struct checkpoint_t
+{
+    /** @brief Identifies the search, see resolver::fingerprint */
+    uint64_t fingerprint = 0;
+    salt_t salt = 0;
+    /** @brief The candidates this search covers */
+    range_t range;
+    /** @brief Every candidate in [range.begin, cursor) has been hashed */
+    uint64_t cursor = 0;
+    /** @brief Targets not found yet */
+    std::vector<hash_t> pending;
+    std::vector<std::pair<hash_t, std::string>> hits;
+};
+
+/**
+ * @brief Write a checkpoint, replacing path only once it is complete
+ * @throws std::ios::failure if the file cannot be written
+ */
+void save_checkpoint(const checkpoint_t& checkpoint, const path_t& path);
+
+/**
+ * @throws std::ios::failure if the file cannot be opened
+ * @throws parse_error if it is not a checkpoint or is truncated
+ */
+checkpoint_t load_checkpoint(const path_t& path);
+
+/**
+ * @brief Combine the checkpoints of the shards of one search
+ * @return The hits of all of them, and the targets none of them found
+ * @throws parse_error if they are not from the same search
+ */
+checkpoint_t merge_checkpoints(std::span<const checkpoint_t> checkpoints);
+
+/**
+ * @brief The part of [0, total) shard index of count covers
+ *
+ * Shards are contiguous and aligned to the chunks workers take, so
+ * independent processes can each run one and be merged afterwards.
+ */
+range_t shard(uint64_t total, size_t index, size_t count);
+
+} // namespace ssharp::fs::resolver
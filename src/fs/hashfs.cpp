@@ -13,14 +13,20 @@
 
 #include "hashfs.hpp"
 
+#include "util/chunk_reader.hpp"
+#include "util/compressor.hpp"
 #include "util/exceptions.hpp"
+#include "util/file.hpp"
+
+#include <algorithm>
+#include <cstring>
 
 namespace ssharp::fs::hashfs
 {
 using namespace ssharp::types;
 namespace ssexcept = ssharp::exceptions;
 
-ssharpfs_t parse(const span_t& span)
+header_t read_header(const span_t& span)
 {
     if (span.size() < sizeof(header_t))
     {
@@ -30,55 +36,313 @@ ssharpfs_t parse(const span_t& span)
             std::to_string(span.size()));
     }
 
+    header_t header;
     auto header_buff = span.get(span_attr_t{0, sizeof(header_t)});
-    const auto header = reinterpret_cast<const header_t*>(header_buff.data());
+    std::memcpy(&header, header_buff.data(), sizeof(header_t));
 
-    if (header->signature != expected_signature)
+    if (header.signature != expected_signature)
     {
         throw ssexcept::parse_error(
             "not a valid hashfs, invalid signature, expected 0x23534353, got " +
-            std::to_string(header->signature));
+            std::to_string(header.signature));
     }
-    if (header->version != expected_version)
+    if (header.version != expected_version)
     {
         throw ssexcept::parse_error(
             "not a valid hashfs, invalid version, expected 0x01, got " +
-            std::to_string(header->version));
+            std::to_string(header.version));
     }
-    if (header->method != expected_method)
+    if (header.method != expected_method)
     {
         throw ssexcept::parse_error(
             "not a valid hashfs, invalid method, expected 0x59544943, got " +
-            std::to_string(header->method));
+            std::to_string(header.method));
     }
 
+    return header;
+}
+
+std::vector<entry_t> read_entries(const span_t& span, const header_t& header)
+{
+    auto table_size = size_t{header.entries_count} * sizeof(entry_t);
+    if (header.offset > span.size() || table_size > span.size() - header.offset)
+    {
+        throw ssexcept::parse_error(
+            "not a valid hashfs, entry table out of range");
+    }
+    // one read for the whole table instead of one per entry
+    auto table = span.get(span_attr_t{header.offset, table_size});
+    std::vector<entry_t> entries(header.entries_count);
+    std::memcpy(entries.data(), table.data(), table_size);
+    return entries;
+}
+
+ssharpfs_t parse(const span_t& span)
+{
+    auto header = read_header(span);
     ssharpfs_t fs;
-    fs.salt = header->salt;
-    auto entries_offset = header->offset;
-    for (uint32_t i = 0; i < header->entries_count; i++)
+    fs.salt = header.salt;
+    for (const auto& entry : read_entries(span, header))
     {
-        auto entry_offset = entries_offset + (i * sizeof(entry_t));
-        auto entry_buff = span.get(span_attr_t{entry_offset, sizeof(entry_t)});
-        const auto entry = reinterpret_cast<const entry_t*>(entry_buff.data());
+        span_t data{span, {entry.offset, entry.compressed_size}};
         std::shared_ptr<ssharpfs::entry_t> entry_ptr;
-        if (entry->flags.is_directory())
+        if (entry.flags.is_directory())
         {
-            entry_ptr = std::make_shared<directory_entry_t>();
+            entry_ptr = std::make_shared<directory_entry_t>(std::move(data));
         }
         else
         {
-            entry_ptr = std::make_shared<generic_entry_t>();
+            entry_ptr = std::make_shared<generic_entry_t>(std::move(data));
         }
-        entry_ptr->is_encrypted = entry->flags.is_encrypted()
+        entry_ptr->is_encrypted = entry.flags.is_encrypted()
                                             ? is_encrypted_t::encrypted
                                             : is_encrypted_t::decrypted;
-        entry_ptr->data = span_t{span, {entry->offset, entry->compressed_size}};
         entry_ptr->compress_attr =
-            entry->flags.is_compressed()
+            entry.flags.is_compressed()
                 ? std::make_optional(compress_attr_t{
-                      compress_type_t::zlib, entry->uncompressed_size})
+                      compress_type_t::zlib, entry.uncompressed_size})
                 : std::nullopt;
-        fs.insert({hash_attr_t{entry->hash, fs.salt}, entry_ptr});
+        fs.insert({hash_attr_t{entry.hash, fs.salt}, entry_ptr});
+    }
+    return fs;
+}
+
+bool verify_entry(const span_t& span, const entry_t& entry)
+{
+    if (entry.flags.is_encrypted())
+        return true;
+    // streamed in bounded chunks, nothing the size of the entry is held
+    uint32_t crc = 0;
+    size_t size = 0;
+    auto update = [&](buff_view_t piece) {
+        crc = util::crc32(piece, crc);
+        size += piece.size();
+    };
+    // a range past the archive or a failed read fails this entry only
+    try
+    {
+        span_t data{span, {entry.offset, entry.compressed_size}};
+        if (!entry.flags.is_compressed())
+        {
+            util::chunk_reader_t reader{data};
+            while (!reader.done())
+                update(reader.next());
+            return crc == entry.crc32;
+        }
+        util::decompress_stream(data, compress_type_t::zlib, update);
+    }
+    catch (const ssexcept::exception&)
+    {
+        return false;
+    }
+    catch (const std::ios::failure&)
+    {
+        return false;
+    }
+    return size == entry.uncompressed_size && crc == entry.crc32;
+}
+
+std::vector<hash_t> verify(const span_t& span, bool all,
+                           util::thread_pool_t& pool)
+{
+    auto entries = read_entries(span, read_header(span));
+    if (!all)
+    {
+        std::erase_if(entries, [](const entry_t& entry) {
+            return !entry.flags.need_varify();
+        });
+    }
+    std::vector<uint8_t> passed(entries.size());
+    pool.parallel_for(entries.size(), [&](size_t i) {
+        passed[i] = verify_entry(span, entries[i]);
+    });
+    std::vector<hash_t> failed;
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        if (!passed[i])
+            failed.push_back(entries[i].hash);
+    }
+    return failed;
+}
+
+namespace
+{
+
+// bounds the compressed data held in memory at once
+constexpr size_t export_batch_bytes = size_t{64} << 20;
+constexpr size_t export_batch_entries = 4096;
+
+struct export_item_t
+{
+    entry_t entry;
+    const ssharpfs::entry_t* source;
+    buff_t storage;
+    // what gets written, either storage or the source's resident data
+    buff_view_t payload;
+};
+
+uint32_t checked_size(size_t size)
+{
+    if (size > UINT32_MAX)
+    {
+        throw ssexcept::exception("hashfs v1 entries must be under 4 GiB");
+    }
+    return static_cast<uint32_t>(size);
+}
+
+void prepare(export_item_t& item)
+{
+    const auto& source = *item.source;
+    auto view = source.data.view();
+    if (!view)
+    {
+        item.storage = source.data.get();
+        view = item.storage;
+    }
+    uint32_t flags = source.file_type() == file_type_t::directory
+                         ? flags_t::directory
+                         : 0;
+    const auto& attr = source.compress_attr;
+    if (source.is_encrypted == is_encrypted_t::encrypted)
+    {
+        // nothing to check or recompress, keep it as it was read
+        flags |= flags_t::encrypted | (attr ? flags_t::compressed : 0);
+        item.entry.flags = flags_t{flags};
+        item.entry.crc32 = 0;
+        item.entry.uncompressed_size =
+            checked_size(attr ? attr->uncompressed_size : view->size());
+        item.payload = *view;
+    }
+    else if (attr && attr->compress_type == compress_type_t::zlib)
+    {
+        // already in the form v1 stores, inflate only for the crc, chunk by
+        // chunk so nothing the size of the entry is held
+        util::inflate_stream_t inflater{compress_type_t::zlib};
+        uint32_t crc = 0;
+        if (!inflater.write(*view, [&](buff_view_t piece) {
+                crc = util::crc32(piece, crc);
+            }))
+        {
+            throw ssexcept::exception("Failed to decompress data: truncated");
+        }
+        if (inflater.total_out() != attr->uncompressed_size)
+        {
+            throw ssexcept::exception("entry size does not match its data");
+        }
+        item.entry.flags = flags_t{flags | flags_t::compressed | flags_t::verify};
+        item.entry.crc32 = crc;
+        item.entry.uncompressed_size = checked_size(attr->uncompressed_size);
+        item.payload = *view;
+    }
+    else
+    {
+        buff_t raw;
+        if (attr)
+        {
+            // another container, v1 only knows zlib
+            raw.resize(attr->uncompressed_size);
+            raw.resize(util::decompress(*view, raw, attr->compress_type));
+            view = raw;
+        }
+        item.entry.crc32 = util::crc32(*view);
+        item.entry.uncompressed_size = checked_size(view->size());
+        if (auto compressed = util::compress_if_gainful(*view, compress_type_t::zlib))
+        {
+            item.storage = std::move(*compressed);
+            item.payload = item.storage;
+            flags |= flags_t::compressed;
+        }
+        else if (!raw.empty())
+        {
+            item.storage = std::move(raw);
+            item.payload = item.storage;
+        }
+        else
+        {
+            item.payload = *view;
+        }
+        item.entry.flags = flags_t{flags | flags_t::verify};
+    }
+    item.entry.compressed_size = checked_size(item.payload.size());
+}
+
+} // namespace
+
+void export_to(const ssharpfs_t& fs, const path_t& output_file_path,
+               util::thread_pool_t& pool)
+{
+    std::vector<export_item_t> items;
+    items.reserve(fs.size());
+    for (const auto& [key, entry] : fs)
+    {
+        export_item_t item{};
+        item.entry.hash = std::holds_alternative<path_t>(key)
+                              ? hash_path(std::get<path_t>(key).generic_string(),
+                                          fs.salt)
+                              : std::get<hash_attr_t>(key).first;
+        item.source = entry.get();
+        items.push_back(std::move(item));
+    }
+    // the table is binary searched by hash
+    std::ranges::sort(items, {}, [](const export_item_t& item) {
+        return item.entry.hash;
+    });
+    auto duplicate = std::ranges::adjacent_find(
+        items, {}, [](const export_item_t& item) { return item.entry.hash; });
+    if (duplicate != items.end())
+    {
+        throw ssexcept::exception("two entries hash to " +
+                                  std::to_string(duplicate->entry.hash));
+    }
+
+    header_t header{expected_signature,
+                    expected_version,
+                    fs.salt,
+                    expected_method,
+                    checked_size(items.size()),
+                    sizeof(header_t),
+                    0};
+    auto offset = header.offset + items.size() * sizeof(entry_t);
+    util::output_file_t file{output_file_path};
+    file.allocate(offset);
+
+    for (size_t first = 0; first < items.size();)
+    {
+        auto last = first;
+        size_t bytes = 0;
+        while (last < items.size() && last - first < export_batch_entries &&
+               (bytes < export_batch_bytes || last == first))
+        {
+            bytes += items[last++].source->data.size();
+        }
+        auto batch = std::span{items}.subspan(first, last - first);
+        pool.parallel_for(batch.size(), [&](size_t i) { prepare(batch[i]); });
+        // offsets follow hash order, never the order compression finished in
+        for (auto& item : batch)
+        {
+            item.entry.offset = offset;
+            offset += item.payload.size();
+        }
+        // stored sizes are only known now, an entry can be stored larger
+        // than its source when it does not deflate
+        file.allocate(offset);
+        pool.parallel_for(batch.size(), [&](size_t i) {
+            file.write_at(batch[i].payload.data(), batch[i].payload.size(),
+                          batch[i].entry.offset);
+            batch[i].storage = {};
+            batch[i].payload = {};
+        });
+        first = last;
+    }
+
+    std::vector<entry_t> entries;
+    entries.reserve(items.size());
+    for (const auto& item : items)
+    {
+        entries.push_back(item.entry);
     }
+    file.write_at(reinterpret_cast<const uint8_t*>(entries.data()),
+                  entries.size() * sizeof(entry_t), header.offset);
+    file.write_at(reinterpret_cast<const uint8_t*>(&header), sizeof(header), 0);
 }
 } // namespace ssharp::fs::hashfs_v1
@@ -12,9 +12,11 @@
 // limitations under the License.
 
 #include "ssharpfs.hpp"
+#include "util/thread_pool.hpp"
 
 #include <bitset>
 #include <expected>
+#include <vector>
 
 namespace ssharp::fs::hashfs
 {
@@ -29,6 +31,16 @@ constexpr uint16_t expected_version = 0x01;
 
 struct flags_t
 {
+    static constexpr uint32_t directory = 0b1;
+    static constexpr uint32_t compressed = 0b10;
+    static constexpr uint32_t verify = 0b100;
+    static constexpr uint32_t encrypted = 0b1000;
+
+    flags_t() = default;
+    constexpr explicit flags_t(uint32_t flags) : flags(flags)
+    {
+    }
+
     bool is_directory() const
     {
         return flags & 0b1;
@@ -60,7 +72,7 @@ struct header_t
     uint64_t offset;
     uint64_t auth_offset;
 };
-static_assert(sizeof(v1_header_t) == 32, "header_t size mismatch");
+static_assert(sizeof(header_t) == 32, "header_t size mismatch");
 
 struct entry_t
 {
@@ -71,11 +83,51 @@ struct entry_t
     uint32_t uncompressed_size;
     uint32_t compressed_size;
 };
-static_assert(sizeof(v1_entry_t) == 32, "entry_t size mismatch");
+static_assert(sizeof(entry_t) == 32, "entry_t size mismatch");
 
 #pragma pack(pop)
 
+/**
+ * @throws parse_error if the span is not a v1 hashfs
+ */
+header_t read_header(const span_t& span);
+std::vector<entry_t> read_entries(const span_t& span, const header_t& header);
+
 ssharpfs_t parse(const span_t& span);
-void export_to(const ssharpfs_t& fs, path_t& output_file_path);
+
+/**
+ * @brief Check the crc32 of an entry against its uncompressed data
+ * @return false on a mismatch or undecodable data, true for encrypted
+ *         entries, which cannot be checked
+ */
+bool verify_entry(const span_t& span, const entry_t& entry);
+
+/**
+ * @brief Check the crc32 of the entries of an archive, in parallel
+ * @param span The archive
+ * @param all Check every entry, not only those flagged need_varify
+ * @param pool The pool to run on
+ * @return The hashes of the entries that failed
+ */
+std::vector<hash_t> verify(const span_t& span, bool all = false,
+                           util::thread_pool_t& pool = util::default_thread_pool());
+
+/**
+ * @brief Write fs as a v1 hashfs, compressing entries on a pool
+ *
+ * Entries are laid out in hash order and compressed in batches. Offsets
+ * are assigned in order once a batch is compressed, the file is allocated
+ * up to the end of the batch and the batch is written in parallel with
+ * positional writes, so the output is byte for byte the same whatever the
+ * number of threads.
+ * Entries that are already compressed or encrypted are copied as they are.
+ * @param fs The archive, paths are hashed with its salt
+ * @param output_file_path The file to create
+ * @param pool The pool to run on
+ * @throws exception if two entries have the same hash or one is over 4 GiB
+ * @throws std::ios::failure if the file cannot be written
+ */
+void export_to(const ssharpfs_t& fs, const path_t& output_file_path,
+               util::thread_pool_t& pool = util::default_thread_pool());
 
 } // namespace ssharp::fs::hashfs
@@ -0,0 +1,265 @@
+// Copyright (C) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "cityhash/city_constexpr.hpp"
+#include "util/types.hpp"
+
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <string_view>
+
+namespace ssharp::fs::ssharpfs
+{
+using namespace ssharp::types;
+
+/**
+ * @brief Names of the locale/ directories the games ship
+ */
+inline constexpr std::array<std::string_view, 43> known_locales{
+    "bg_bg", "ca_es", "cs_cz", "da_dk", "de_de", "el_gr", "en_gb", "en_us",
+    "es_es", "es_la", "et_ee", "eu_es", "fi_fi", "fr_ca", "fr_fr", "gl_es",
+    "hr_hr", "hu_hu", "it_it", "ja_jp", "ka_ge", "ko_kr", "lt_lt", "lv_lv",
+    "mk_mk", "nl_nl", "no_no", "pl_pl", "pt_br", "pt_pt", "ro_ro", "ru_ru",
+    "sk_sk", "sl_sl", "sr_sp", "sr_sr", "sv_se", "th_th", "tr_tr", "uk_uk",
+    "vi_vn", "zh_cn", "zh_tw",
+};
+
+/**
+ * @brief A path every archive is likely to contain, with its unsalted hash
+ */
+struct known_path_t
+{
+    std::string_view path;
+    hash_t hash;
+};
+
+/**
+ * @brief Hash a path literal at compile time, the same way hash_path does
+ * @param path The path, a leading '/' is ignored
+ */
+consteval known_path_t known_path(std::string_view path)
+{
+    if (path.starts_with('/'))
+    {
+        path.remove_prefix(1);
+    }
+    return {path, cityhash::constexpr_hash::CityHash64(path)};
+}
+
+/**
+ * @brief Paths seeded into every archive, sorted by hash
+ */
+inline constexpr auto known_paths = [] {
+    auto paths = std::to_array<known_path_t>({
+    // top level
+    known_path(""),
+    known_path("automat"),
+    known_path("def"),
+    known_path("effect"),
+    known_path("font"),
+    known_path("locale"),
+    known_path("map"),
+    known_path("material"),
+    known_path("model"),
+    known_path("prefab"),
+    known_path("sound"),
+    known_path("system"),
+    known_path("ui"),
+    known_path("unit"),
+    known_path("vehicle"),
+    known_path("manifest.sii"),
+    known_path("version.sii"),
+    // def/ and the icon directory sii::find_paths prefixes
+    known_path("def/city.sii"),
+    known_path("def/country.sii"),
+    known_path("def/company.sii"),
+    known_path("def/cargo"),
+    known_path("def/world"),
+    known_path("def/vehicle"),
+    known_path("def/vehicle/truck"),
+    known_path("def/vehicle/trailer"),
+    known_path("def/economy_data.sii"),
+    known_path("def/game_data.sii"),
+    known_path("def/ui_data.sii"),
+    known_path("material/ui"),
+    known_path("material/ui/accessory"),
+    // locales
+    known_path("locale/bg_bg"),
+    known_path("locale/bg_bg/local.sii"),
+    known_path("locale/bg_bg/local.override.sii"),
+    known_path("locale/ca_es"),
+    known_path("locale/ca_es/local.sii"),
+    known_path("locale/ca_es/local.override.sii"),
+    known_path("locale/cs_cz"),
+    known_path("locale/cs_cz/local.sii"),
+    known_path("locale/cs_cz/local.override.sii"),
+    known_path("locale/da_dk"),
+    known_path("locale/da_dk/local.sii"),
+    known_path("locale/da_dk/local.override.sii"),
+    known_path("locale/de_de"),
+    known_path("locale/de_de/local.sii"),
+    known_path("locale/de_de/local.override.sii"),
+    known_path("locale/el_gr"),
+    known_path("locale/el_gr/local.sii"),
+    known_path("locale/el_gr/local.override.sii"),
+    known_path("locale/en_gb"),
+    known_path("locale/en_gb/local.sii"),
+    known_path("locale/en_gb/local.override.sii"),
+    known_path("locale/en_us"),
+    known_path("locale/en_us/local.sii"),
+    known_path("locale/en_us/local.override.sii"),
+    known_path("locale/es_es"),
+    known_path("locale/es_es/local.sii"),
+    known_path("locale/es_es/local.override.sii"),
+    known_path("locale/es_la"),
+    known_path("locale/es_la/local.sii"),
+    known_path("locale/es_la/local.override.sii"),
+    known_path("locale/et_ee"),
+    known_path("locale/et_ee/local.sii"),
+    known_path("locale/et_ee/local.override.sii"),
+    known_path("locale/eu_es"),
+    known_path("locale/eu_es/local.sii"),
+    known_path("locale/eu_es/local.override.sii"),
+    known_path("locale/fi_fi"),
+    known_path("locale/fi_fi/local.sii"),
+    known_path("locale/fi_fi/local.override.sii"),
+    known_path("locale/fr_ca"),
+    known_path("locale/fr_ca/local.sii"),
+    known_path("locale/fr_ca/local.override.sii"),
+    known_path("locale/fr_fr"),
+    known_path("locale/fr_fr/local.sii"),
+    known_path("locale/fr_fr/local.override.sii"),
+    known_path("locale/gl_es"),
+    known_path("locale/gl_es/local.sii"),
+    known_path("locale/gl_es/local.override.sii"),
+    known_path("locale/hr_hr"),
+    known_path("locale/hr_hr/local.sii"),
+    known_path("locale/hr_hr/local.override.sii"),
+    known_path("locale/hu_hu"),
+    known_path("locale/hu_hu/local.sii"),
+    known_path("locale/hu_hu/local.override.sii"),
+    known_path("locale/it_it"),
+    known_path("locale/it_it/local.sii"),
+    known_path("locale/it_it/local.override.sii"),
+    known_path("locale/ja_jp"),
+    known_path("locale/ja_jp/local.sii"),
+    known_path("locale/ja_jp/local.override.sii"),
+    known_path("locale/ka_ge"),
+    known_path("locale/ka_ge/local.sii"),
+    known_path("locale/ka_ge/local.override.sii"),
+    known_path("locale/ko_kr"),
+    known_path("locale/ko_kr/local.sii"),
+    known_path("locale/ko_kr/local.override.sii"),
+    known_path("locale/lt_lt"),
+    known_path("locale/lt_lt/local.sii"),
+    known_path("locale/lt_lt/local.override.sii"),
+    known_path("locale/lv_lv"),
+    known_path("locale/lv_lv/local.sii"),
+    known_path("locale/lv_lv/local.override.sii"),
+    known_path("locale/mk_mk"),
+    known_path("locale/mk_mk/local.sii"),
+    known_path("locale/mk_mk/local.override.sii"),
+    known_path("locale/nl_nl"),
+    known_path("locale/nl_nl/local.sii"),
+    known_path("locale/nl_nl/local.override.sii"),
+    known_path("locale/no_no"),
+    known_path("locale/no_no/local.sii"),
+    known_path("locale/no_no/local.override.sii"),
+    known_path("locale/pl_pl"),
+    known_path("locale/pl_pl/local.sii"),
+    known_path("locale/pl_pl/local.override.sii"),
+    known_path("locale/pt_br"),
+    known_path("locale/pt_br/local.sii"),
+    known_path("locale/pt_br/local.override.sii"),
+    known_path("locale/pt_pt"),
+    known_path("locale/pt_pt/local.sii"),
+    known_path("locale/pt_pt/local.override.sii"),
+    known_path("locale/ro_ro"),
+    known_path("locale/ro_ro/local.sii"),
+    known_path("locale/ro_ro/local.override.sii"),
+    known_path("locale/ru_ru"),
+    known_path("locale/ru_ru/local.sii"),
+    known_path("locale/ru_ru/local.override.sii"),
+    known_path("locale/sk_sk"),
+    known_path("locale/sk_sk/local.sii"),
+    known_path("locale/sk_sk/local.override.sii"),
+    known_path("locale/sl_sl"),
+    known_path("locale/sl_sl/local.sii"),
+    known_path("locale/sl_sl/local.override.sii"),
+    known_path("locale/sr_sp"),
+    known_path("locale/sr_sp/local.sii"),
+    known_path("locale/sr_sp/local.override.sii"),
+    known_path("locale/sr_sr"),
+    known_path("locale/sr_sr/local.sii"),
+    known_path("locale/sr_sr/local.override.sii"),
+    known_path("locale/sv_se"),
+    known_path("locale/sv_se/local.sii"),
+    known_path("locale/sv_se/local.override.sii"),
+    known_path("locale/th_th"),
+    known_path("locale/th_th/local.sii"),
+    known_path("locale/th_th/local.override.sii"),
+    known_path("locale/tr_tr"),
+    known_path("locale/tr_tr/local.sii"),
+    known_path("locale/tr_tr/local.override.sii"),
+    known_path("locale/uk_uk"),
+    known_path("locale/uk_uk/local.sii"),
+    known_path("locale/uk_uk/local.override.sii"),
+    known_path("locale/vi_vn"),
+    known_path("locale/vi_vn/local.sii"),
+    known_path("locale/vi_vn/local.override.sii"),
+    known_path("locale/zh_cn"),
+    known_path("locale/zh_cn/local.sii"),
+    known_path("locale/zh_cn/local.override.sii"),
+    known_path("locale/zh_tw"),
+    known_path("locale/zh_tw/local.sii"),
+    known_path("locale/zh_tw/local.override.sii"),
+    });
+    std::ranges::sort(paths, {}, &known_path_t::hash);
+    return paths;
+}();
+
+static_assert(std::ranges::adjacent_find(known_paths, {}, &known_path_t::hash) ==
+                  known_paths.end(),
+              "known paths must not collide");
+
+// pinned against cityhash::CityHash64 so the two implementations cannot drift
+static_assert(known_path("").hash == 0x9ae16a3b2f90404fULL);
+static_assert(known_path("/def").hash == 0x2c6f469efb31c45aULL);
+static_assert(known_path("manifest.sii").hash == 0xb97fff7ce7377c95ULL);
+static_assert(known_path("material/ui/accessory").hash == 0x4d1c2d78cf004cfeULL);
+static_assert(known_path("def/economy_data.sii").hash == 0xce3123f8a189862eULL);
+static_assert(known_path("locale/en_us/local.override.sii").hash ==
+              0x8271f57e4ce5e213ULL);
+static_assert(cityhash::constexpr_hash::CityHash64(
+                  "def/vehicle/truck/scania.streamline/accessory/head_lights/"
+                  "default_lights.sii") == 0xaa1fa4c9cd256314ULL);
+static_assert(cityhash::constexpr_hash::CityHash64Salted(42, "def/city.sii") ==
+              0x04f72392f4217fc2ULL);
+
+/**
+ * @brief Look up an unsalted hash in known_paths
+ */
+constexpr std::optional<std::string_view> find_known_path(hash_t hash)
+{
+    auto it = std::ranges::lower_bound(known_paths, hash, {}, &known_path_t::hash);
+    if (it == known_paths.end() || it->hash != hash)
+    {
+        return std::nullopt;
+    }
+    return it->path;
+}
+
+} // namespace ssharp::fs::ssharpfs
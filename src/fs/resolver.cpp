@@ -0,0 +1,309 @@
+// Copyright (C) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "resolver.hpp"
+
+#include "cityhash/city.hpp"
+#include "util/exceptions.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <mutex>
+
+namespace ssharp::fs::resolver
+{
+namespace ssexcept = ssharp::exceptions;
+
+void vocabulary_t::add_path(std::string_view path, bool is_directory)
+{
+    if (path.starts_with('/'))
+    {
+        path.remove_prefix(1);
+    }
+    if (path.empty())
+    {
+        return;
+    }
+    // every directory above the path, and their names as stems
+    size_t begin = 0;
+    for (auto slash = path.find('/'); slash != std::string_view::npos;
+         slash = path.find('/', begin))
+    {
+        if (slash > begin)
+        {
+            directories.emplace(path.substr(0, slash));
+            stems.emplace(path.substr(begin, slash - begin));
+        }
+        begin = slash + 1;
+    }
+    auto name = path.substr(begin);
+    if (name.empty())
+    {
+        return;
+    }
+    if (is_directory)
+    {
+        directories.emplace(path);
+        stems.emplace(name);
+        return;
+    }
+    auto dot = name.rfind('.');
+    if (dot == std::string_view::npos || dot == 0)
+    {
+        stems.emplace(name);
+        return;
+    }
+    stems.emplace(name.substr(0, dot));
+    extensions.emplace(name.substr(dot));
+}
+
+uint64_t vocabulary_t::candidates() const
+{
+    return uint64_t{directories.size()} * stems.size() * extensions.size();
+}
+
+hash_set_t::hash_set_t(std::span<const hash_t> hashes)
+{
+    // at most half full, so a miss usually stops at the first empty slot
+    auto size = std::bit_ceil(std::max<size_t>(hashes.size() * 2, 16));
+    slots.assign(size, empty);
+    mask = size - 1;
+    for (auto hash : hashes)
+    {
+        if (hash == empty)
+        {
+            count += !has_empty;
+            has_empty = true;
+            continue;
+        }
+        auto i = hash & mask;
+        while (slots[i] != empty && slots[i] != hash)
+        {
+            i = (i + 1) & mask;
+        }
+        count += slots[i] == empty;
+        slots[i] = hash;
+    }
+}
+
+void fingerprint_t::add(std::string_view part)
+{
+    add(cityhash::CityHash64(part.data(), part.size()));
+}
+
+void fingerprint_t::add(uint64_t part)
+{
+    // order matters, the same parts in another order are another search
+    constexpr uint64_t kMul = 0x9ddfea08eb382d69ULL;
+    state = (state ^ part) * kMul;
+    state ^= state >> 47;
+}
+
+namespace
+{
+// candidates hashed per batch call
+constexpr size_t batch_size = 1024;
+} // namespace
+
+result_t search(uint64_t total, const generator_t& generate,
+                uint64_t fingerprint, std::span<const hash_t> targets,
+                salt_t salt, const options_t& options, util::thread_pool_t& pool)
+{
+    checkpoint_t state;
+    state.fingerprint = fingerprint;
+    state.salt = salt;
+    state.range = options.range.value_or(range_t{0, total});
+    state.range.end = std::min(state.range.end, total);
+    state.range.begin = std::min(state.range.begin, state.range.end);
+    state.cursor = state.range.begin;
+    state.pending.assign(targets.begin(), targets.end());
+    if (options.resume && !options.checkpoint.empty() &&
+        std::filesystem::exists(options.checkpoint))
+    {
+        auto saved = load_checkpoint(options.checkpoint);
+        if (saved.fingerprint != fingerprint || saved.salt != salt ||
+            saved.range != state.range)
+        {
+            throw ssexcept::parse_error("checkpoint " + options.checkpoint.string() +
+                                        " is from another search");
+        }
+        state = std::move(saved);
+    }
+    const auto first = state.cursor;
+    const auto last = state.range.end;
+
+    // the salt goes in front of every candidate as it is built, so the
+    // unsalted batch hash can be used directly
+    const auto prefix = salt ? std::to_string(salt) : std::string{};
+
+    const hash_set_t set{state.pending};
+    auto claimed = std::make_unique<std::atomic<bool>[]>(set.capacity());
+
+    result_t result;
+    result.hits = std::move(state.hits);
+    std::mutex mutex;
+    std::atomic<uint64_t> done = 0;
+    const auto start = std::chrono::steady_clock::now();
+    auto last_report = start;
+    auto last_checkpoint = start;
+    auto snapshot = [&]() {
+        progress_t progress;
+        progress.resumed = first - state.range.begin;
+        progress.candidates = progress.resumed + done;
+        progress.total = state.range.end - state.range.begin;
+        progress.hits = result.hits.size();
+        progress.elapsed = std::chrono::steady_clock::now() - start;
+        return progress;
+    };
+
+    auto chunks = set.size() ? (last - first + chunk_size - 1) / chunk_size : 0;
+    // chunks finish out of order, the checkpoint cursor only moves past
+    // those finished without a gap, the rest are redone after a resume
+    auto finished = std::make_unique<std::atomic<bool>[]>(chunks);
+    size_t contiguous = 0;
+    auto save = [&](uint64_t cursor) {
+        state.cursor = cursor;
+        state.pending.clear();
+        for (auto hash : targets)
+        {
+            auto slot = set.find(hash);
+            if (slot != hash_set_t::npos && !claimed[slot])
+                state.pending.push_back(hash);
+        }
+        state.hits = result.hits;
+        save_checkpoint(state, options.checkpoint);
+    };
+
+    pool.parallel_for(chunks, [&](size_t chunk) {
+        auto begin = first + chunk * chunk_size;
+        auto count = std::min(chunk_size, last - begin);
+        candidates_t batch{prefix};
+        std::vector<std::string_view> views;
+        std::vector<uint64_t> hashes(batch_size);
+        for (uint64_t base = 0; base < count; base += batch_size)
+        {
+            batch.clear();
+            generate(begin + base, std::min<uint64_t>(batch_size, count - base),
+                     batch);
+            views.clear();
+            for (size_t i = 0; i < batch.size(); i++)
+            {
+                views.push_back(batch[i]);
+            }
+            cityhash::CityHash64(views, hashes);
+            for (size_t i = 0; i < views.size(); i++)
+            {
+                auto slot = set.find(hashes[i]);
+                if (slot == hash_set_t::npos || claimed[slot])
+                {
+                    continue;
+                }
+                // claimed and recorded under the lock save() holds, so a
+                // checkpoint never sees a target that is in neither pending
+                // nor hits
+                std::lock_guard lock{mutex};
+                if (claimed[slot].exchange(true))
+                {
+                    continue;
+                }
+                auto path = views[i].substr(prefix.size());
+                result.hits.emplace_back(hashes[i], path);
+                if (options.on_hit)
+                {
+                    options.on_hit(hashes[i], path);
+                }
+            }
+        }
+        done += count;
+        finished[chunk] = true;
+
+        if (!options.on_progress && options.checkpoint.empty())
+        {
+            return;
+        }
+        // a worker that finds the lock busy leaves the report to the other
+        std::unique_lock lock{mutex, std::try_to_lock};
+        if (!lock)
+        {
+            return;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (options.on_progress && now - last_report >= options.progress_interval)
+        {
+            last_report = now;
+            options.on_progress(snapshot());
+        }
+        if (!options.checkpoint.empty() &&
+            now - last_checkpoint >= options.checkpoint_interval)
+        {
+            last_checkpoint = now;
+            while (contiguous < chunks && finished[contiguous])
+            {
+                contiguous++;
+            }
+            save(std::min(first + contiguous * chunk_size, last));
+        }
+    });
+
+    result.progress = snapshot();
+    if (!options.checkpoint.empty())
+    {
+        save(last);
+    }
+    return result;
+}
+
+result_t brute_force(const vocabulary_t& vocabulary,
+                     std::span<const hash_t> targets, salt_t salt,
+                     const options_t& options, util::thread_pool_t& pool)
+{
+    const std::vector<std::string> directories(vocabulary.directories.begin(),
+                                               vocabulary.directories.end());
+    const std::vector<std::string> stems(vocabulary.stems.begin(),
+                                         vocabulary.stems.end());
+    const std::vector<std::string> extensions(vocabulary.extensions.begin(),
+                                              vocabulary.extensions.end());
+    auto generate = [&](uint64_t first, size_t count, candidates_t& out) {
+        // position of the first candidate, advanced like an odometer
+        auto e = first % extensions.size();
+        auto s = first / extensions.size() % stems.size();
+        auto d = first / extensions.size() / stems.size();
+        for (size_t i = 0; i < count; i++)
+        {
+            if (directories[d].empty())
+                out.add(stems[s], extensions[e]);
+            else
+                out.add(directories[d], '/', stems[s], extensions[e]);
+            if (++e == extensions.size())
+            {
+                e = 0;
+                if (++s == stems.size())
+                {
+                    s = 0;
+                    d++;
+                }
+            }
+        }
+    };
+    fingerprint_t fingerprint;
+    for (const auto* part : {&directories, &stems, &extensions})
+    {
+        fingerprint.add(part->size());
+        for (const auto& name : *part)
+            fingerprint.add(name);
+    }
+    return search(vocabulary.candidates(), generate, fingerprint.value(),
+                  targets, salt, options, pool);
+}
+
+} // namespace ssharp::fs::resolver
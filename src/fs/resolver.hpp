@@ -0,0 +1,277 @@
+// Copyright (C) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "fs/checkpoint.hpp"
+#include "util/thread_pool.hpp"
+#include "util/types.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <set>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ssharp::fs::resolver
+{
+using namespace ssharp::types;
+
+/**
+ * @brief Candidates a worker takes at a time, the unit of progress,
+ *        checkpoints and shards
+ */
+inline constexpr uint64_t chunk_size = uint64_t{1} << 16;
+
+/**
+ * @brief Names seen in an archive, the building blocks of candidate paths
+ */
+struct vocabulary_t
+{
+    /** @brief Directory paths without a leading '/', "" is the root */
+    std::set<std::string> directories{""};
+    /** @brief File names without their extension, and directory names */
+    std::set<std::string> stems;
+    /** @brief Extensions with their dot, "" stands for none */
+    std::set<std::string> extensions{""};
+
+    /**
+     * @brief Add a path and every directory above it
+     * @param path The path, a leading '/' is ignored
+     * @param is_directory Whether the path itself is a directory
+     */
+    void add_path(std::string_view path, bool is_directory = false);
+
+    /**
+     * @brief Number of candidates, directories x stems x extensions
+     */
+    uint64_t candidates() const;
+};
+
+/**
+ * @brief An open-addressed set of hashes, read-only once built
+ *
+ * Lookups take no lock and touch one or two cache lines, which matters
+ * when every worker probes it millions of times a second.
+ */
+class hash_set_t
+{
+  public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    explicit hash_set_t(std::span<const hash_t> hashes);
+
+    /**
+     * @return The slot of hash, or npos if it is not in the set
+     */
+    size_t find(hash_t hash) const
+    {
+        if (hash == empty)
+        {
+            return has_empty ? slots.size() : npos;
+        }
+        for (size_t i = hash & mask;; i = (i + 1) & mask)
+        {
+            if (slots[i] == hash)
+                return i;
+            if (slots[i] == empty)
+                return npos;
+        }
+    }
+
+    /**
+     * @brief One past the largest slot find can return
+     */
+    size_t capacity() const
+    {
+        return slots.size() + 1;
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+  private:
+    static constexpr hash_t empty = 0;
+    std::vector<hash_t> slots;
+    size_t mask = 0;
+    size_t count = 0;
+    bool has_empty = false;
+};
+
+struct progress_t
+{
+    uint64_t candidates = 0;
+    uint64_t total = 0;
+    /** @brief Of candidates, those done before a resume */
+    uint64_t resumed = 0;
+    size_t hits = 0;
+    std::chrono::duration<double> elapsed{};
+
+    /**
+     * @brief Hashes per second so far in this run
+     */
+    double rate() const
+    {
+        return elapsed.count() > 0 ? (candidates - resumed) / elapsed.count() : 0;
+    }
+};
+
+struct options_t
+{
+    /**
+     * @brief Called for every hit as it is found, from a worker thread but
+     *        never from two at once
+     */
+    std::function<void(hash_t hash, std::string_view path)> on_hit;
+    /**
+     * @brief Called about every progress_interval, same threading as on_hit
+     */
+    std::function<void(const progress_t& progress)> on_progress;
+    std::chrono::milliseconds progress_interval{1000};
+    /**
+     * @brief Only search these candidates, all of them by default, see shard
+     */
+    std::optional<range_t> range;
+    /**
+     * @brief Save the state of the search here every checkpoint_interval
+     *        and when it ends, nothing is saved if empty
+     */
+    path_t checkpoint;
+    std::chrono::seconds checkpoint_interval{60};
+    /**
+     * @brief Continue from checkpoint if it exists instead of starting over
+     */
+    bool resume = false;
+};
+
+struct result_t
+{
+    std::vector<std::pair<hash_t, std::string>> hits;
+    progress_t progress;
+};
+
+/**
+ * @brief Identifies a search by what it is made of, so a checkpoint is
+ *        never resumed by another one
+ */
+class fingerprint_t
+{
+  public:
+    void add(std::string_view part);
+    void add(uint64_t part);
+
+    uint64_t value() const
+    {
+        return state;
+    }
+
+  private:
+    uint64_t state = 0;
+};
+
+/**
+ * @brief A batch of candidate paths, packed into one reused buffer
+ */
+class candidates_t
+{
+  public:
+    explicit candidates_t(std::string_view prefix) : prefix(prefix)
+    {
+    }
+
+    /**
+     * @brief Append the concatenation of parts as one candidate
+     */
+    template <typename... parts_t>
+    void add(const parts_t&... parts)
+    {
+        arena += prefix;
+        ((arena += parts), ...);
+        ends.push_back(arena.size());
+    }
+
+    void clear()
+    {
+        arena.clear();
+        ends.clear();
+    }
+
+    size_t size() const
+    {
+        return ends.size();
+    }
+
+    /**
+     * @brief The candidate at i, including the salt prefix
+     */
+    std::string_view operator[](size_t i) const
+    {
+        auto begin = i ? ends[i - 1] : 0;
+        return std::string_view{arena}.substr(begin, ends[i] - begin);
+    }
+
+    std::string_view prefix;
+
+  private:
+    std::string arena;
+    std::vector<size_t> ends;
+};
+
+/**
+ * @brief Adds the candidates numbered [first, first + count) to a batch,
+ *        or fewer if some of them do not exist
+ */
+using generator_t =
+    std::function<void(uint64_t first, size_t count, candidates_t& out)>;
+
+/**
+ * @brief Hash candidates [0, total) on all threads and keep those that hit
+ * @param total Number of candidates generate can produce
+ * @param generate Produces the candidates, called concurrently
+ * @param fingerprint Identifies what generate produces, see fingerprint_t
+ * @param targets The hashes to find
+ * @param salt The salt the targets were hashed with
+ * @param options Live reporting, range and checkpoints
+ * @param pool The pool to run on
+ * @return Every target found, each once, in no particular order, including
+ *         those found before a resume
+ * @throws parse_error if options.resume finds a checkpoint of another search
+ */
+result_t search(uint64_t total, const generator_t& generate,
+                uint64_t fingerprint, std::span<const hash_t> targets,
+                salt_t salt,
+                const options_t& options = {},
+                util::thread_pool_t& pool = util::default_thread_pool());
+
+/**
+ * @brief Hash every candidate path of a vocabulary and keep those that hit
+ * @param vocabulary Where candidates come from, see vocabulary_t::candidates
+ * @param targets The hashes to find
+ * @param salt The salt the targets were hashed with
+ * @param options Live reporting, range and checkpoints
+ * @param pool The pool to run on
+ * @return Every target found, each once, in no particular order
+ */
+result_t brute_force(const vocabulary_t& vocabulary,
+                     std::span<const hash_t> targets, salt_t salt,
+                     const options_t& options = {},
+                     util::thread_pool_t& pool = util::default_thread_pool());
+
+} // namespace ssharp::fs::resolver
@@ -0,0 +1,334 @@
+// Copyright (C) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rules.hpp"
+
+#include "fs/known_paths.hpp"
+#include "util/exceptions.hpp"
+
+#include <cctype>
+
+namespace ssharp::fs::resolver
+{
+namespace ssexcept = ssharp::exceptions;
+
+path_parts_t::path_parts_t(std::string_view path)
+{
+    if (path.starts_with('/'))
+    {
+        path.remove_prefix(1);
+    }
+    auto slash = path.rfind('/');
+    if (slash != std::string_view::npos)
+    {
+        directory = path.substr(0, slash);
+        path.remove_prefix(slash + 1);
+    }
+    auto dot = path.rfind('.');
+    if (dot == std::string_view::npos || dot == 0)
+    {
+        stem = path;
+        return;
+    }
+    stem = path.substr(0, dot);
+    extension = path.substr(dot);
+}
+
+rule_t::rule_t(std::string_view text) : source(text)
+{
+    auto fail = [&](const std::string& what) {
+        throw ssexcept::parse_error("invalid rule \"" + source + "\", " + what);
+    };
+    std::vector<op_t> ops;
+    size_t i = 0;
+    // names run to the next whitespace
+    auto name = [&]() {
+        auto end = std::min(text.find_first_of(" \t", i), text.size());
+        auto result = std::string{text.substr(i, end - i)};
+        i = end;
+        return result;
+    };
+    while (i < text.size())
+    {
+        char op = text[i++];
+        switch (op)
+        {
+        case ' ':
+        case '\t':
+        case ':':
+            break;
+        case '$':
+        case '^':
+            if (i + 1 > text.size())
+                fail(std::string{"missing character after '"} + op + "'");
+            ops.push_back({op, text[i++]});
+            break;
+        case 's':
+            if (i + 2 > text.size())
+                fail("missing characters after 's'");
+            ops.push_back({op, text[i], text[i + 1]});
+            i += 2;
+            break;
+        case ']':
+        case '[':
+        case 'l':
+        case 'u':
+            ops.push_back({op});
+            break;
+        case 'e':
+            extension = name();
+            if (!extension->empty() && !extension->starts_with('.'))
+                fail("extension must start with '.'");
+            break;
+        case 'd':
+        case 'D':
+            directory_ops.push_back({op, 0, 0, name()});
+            if (directory_ops.back().name.empty())
+                fail(std::string{"missing name after '"} + op + "'");
+            break;
+        default:
+            fail(std::string{"unknown operation '"} + op + "'");
+        }
+    }
+
+    // fold the stem operations into prefix + stem[trim_front, -trim_back) +
+    // suffix, which holds as long as the trims do not reach past the stem,
+    // apply() runs them one by one on stems too short for that
+    stem_ops = std::move(ops);
+    for (const auto& op : stem_ops)
+    {
+        switch (op.op)
+        {
+        case '$':
+            suffix += op.from;
+            break;
+        case '^':
+            prefix.insert(prefix.begin(), op.from);
+            break;
+        case ']':
+            if (suffix.empty())
+                trim_back++;
+            else
+                suffix.pop_back();
+            break;
+        case '[':
+            if (prefix.empty())
+                trim_front++;
+            else
+                prefix.erase(0, 1);
+            break;
+        default:
+            prefix.clear();
+            suffix.clear();
+            trim_front = trim_back = 0;
+            folded = false;
+            return;
+        }
+    }
+}
+
+bool rule_t::apply(const path_parts_t& path, candidates_t& out,
+                   path_parts_t& scratch) const
+{
+    std::string_view directory = path.directory;
+    if (!directory_ops.empty())
+    {
+        scratch.directory = path.directory;
+        for (const auto& op : directory_ops)
+        {
+            if (op.op == 'd')
+            {
+                if (scratch.directory.empty())
+                    return false;
+                auto slash = scratch.directory.rfind('/');
+                scratch.directory.resize(slash == std::string::npos ? 0 : slash + 1);
+            }
+            else if (!scratch.directory.empty())
+            {
+                scratch.directory += '/';
+            }
+            scratch.directory += op.name;
+        }
+        directory = scratch.directory;
+    }
+    std::string_view extension = this->extension ? *this->extension : path.extension;
+    auto add = [&](const auto&... stem) {
+        if (directory.empty())
+            out.add(stem..., extension);
+        else
+            out.add(directory, '/', stem..., extension);
+    };
+
+    if (folded && trim_front + trim_back <= path.stem.size())
+    {
+        auto stem = std::string_view{path.stem}.substr(
+            trim_front, path.stem.size() - trim_front - trim_back);
+        if (prefix.empty() && stem.empty() && suffix.empty())
+            return false;
+        add(prefix, stem, suffix);
+        return true;
+    }
+
+    auto& stem = scratch.stem;
+    stem = path.stem;
+    for (const auto& op : stem_ops)
+    {
+        switch (op.op)
+        {
+        case '$':
+            stem += op.from;
+            break;
+        case '^':
+            stem.insert(stem.begin(), op.from);
+            break;
+        case ']':
+            if (stem.empty())
+                return false;
+            stem.pop_back();
+            break;
+        case '[':
+            if (stem.empty())
+                return false;
+            stem.erase(0, 1);
+            break;
+        case 's':
+            std::ranges::replace(stem, op.from, op.to);
+            break;
+        case 'l':
+            for (auto& c : stem)
+                c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            break;
+        case 'u':
+            for (auto& c : stem)
+                c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            break;
+        }
+    }
+    if (stem.empty())
+        return false;
+    add(stem);
+    return true;
+}
+
+std::vector<rule_t> compile_rules(std::string_view text)
+{
+    std::vector<rule_t> rules;
+    size_t number = 0;
+    while (!text.empty())
+    {
+        auto end = std::min(text.find('\n'), text.size());
+        auto line = text.substr(0, end);
+        text.remove_prefix(std::min(end + 1, text.size()));
+        number++;
+        if (line.ends_with('\r'))
+            line.remove_suffix(1);
+        if (line.empty() || line.starts_with('#'))
+            continue;
+        try
+        {
+            rules.emplace_back(line);
+        }
+        catch (const ssexcept::parse_error& e)
+        {
+            throw ssexcept::parse_error("line " + std::to_string(number) + ": " +
+                                        e.what());
+        }
+    }
+    return rules;
+}
+
+const std::vector<rule_t>& default_rules()
+{
+    static const auto rules = [] {
+        auto rules = compile_rules(R"(# the path as it is, parsed paths are often unresolved themselves
+:
+# numbered variants
+$_$0
+$_$1
+$_$2
+$_$3
+]$0
+]$1
+]$2
+]$3
+]
+]]
+# sibling model files
+e.pmd
+e.pmg
+e.ppd
+e.pma
+e.pmc
+# textures, materials and normal maps
+e.tobj
+e.dds
+e.mat
+$_$n$m$a$p e.tobj
+$_$n$m$a$p e.dds
+$_$n$m$a$p e.mat
+]]]]] e.tobj
+]]]]] e.dds
+]]]]] e.mat
+# definitions and sounds
+e.sii
+e.sui
+e.soundref
+e.bank
+)");
+        // the same file for every other locale
+        for (auto locale : ssharpfs::known_locales)
+        {
+            rules.emplace_back("d" + std::string{locale});
+        }
+        return rules;
+    }();
+    return rules;
+}
+
+result_t mutate(std::span<const std::string> paths,
+                std::span<const rule_t> rules, std::span<const hash_t> targets,
+                salt_t salt, const options_t& options, util::thread_pool_t& pool)
+{
+    // split once, every rule sees the same parts
+    std::vector<path_parts_t> parts;
+    parts.reserve(paths.size());
+    for (const auto& path : paths)
+    {
+        parts.emplace_back(path);
+    }
+    auto generate = [&](uint64_t first, size_t count, candidates_t& out) {
+        path_parts_t scratch;
+        auto p = first / rules.size();
+        auto r = first % rules.size();
+        for (size_t i = 0; i < count; i++)
+        {
+            rules[r].apply(parts[p], out, scratch);
+            if (++r == rules.size())
+            {
+                r = 0;
+                p++;
+            }
+        }
+    };
+    fingerprint_t fingerprint;
+    fingerprint.add(paths.size());
+    for (const auto& path : paths)
+        fingerprint.add(path);
+    fingerprint.add(rules.size());
+    for (const auto& rule : rules)
+        fingerprint.add(rule.text());
+    return search(uint64_t{parts.size()} * rules.size(), generate,
+                  fingerprint.value(), targets, salt, options, pool);
+}
+
+} // namespace ssharp::fs::resolver
@@ -0,0 +1,128 @@
+// Copyright (C) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "fs/resolver.hpp"
+
+#include <optional>
+
+namespace ssharp::fs::resolver
+{
+
+/**
+ * @brief A path split into the parts rules work on
+ */
+struct path_parts_t
+{
+    /** @brief Without a leading '/', "" is the root */
+    std::string directory;
+    /** @brief The file name without its extension */
+    std::string stem;
+    /** @brief With its dot, "" if there is none */
+    std::string extension;
+
+    path_parts_t() = default;
+    explicit path_parts_t(std::string_view path);
+};
+
+/**
+ * @brief A compiled mutation rule, in the spirit of hashcat rules
+ *
+ * A rule is a sequence of operations, whitespace between them is optional
+ * except after those taking a name:
+ *   :        nothing
+ *   $c  ^c   append or prepend c to the stem
+ *   ]   [    delete the last or first character of the stem
+ *   sxy      replace every x in the stem by y
+ *   l   u    lower or upper case the stem
+ *   e.ext    replace the extension, a bare e removes it
+ *   dname    replace the innermost directory by name
+ *   Dname    descend into the subdirectory name
+ *
+ * Appends, prepends and deletes are folded into a fixed prefix, suffix and
+ * trim when the rule is compiled, so most rules cost a few appends per
+ * candidate. Rules with s, l or u run their operations one by one, and so
+ * do the others on stems shorter than their deletes, where deleting goes on
+ * into the characters added around the stem.
+ */
+class rule_t
+{
+  public:
+    /**
+     * @throws parse_error on an unknown operation or a missing argument
+     */
+    explicit rule_t(std::string_view text);
+
+    /**
+     * @brief Add the mutation of path to out
+     * @param scratch Reused between calls to avoid allocating
+     * @return false if the rule does not apply to path, nothing is added
+     */
+    bool apply(const path_parts_t& path, candidates_t& out,
+               path_parts_t& scratch) const;
+
+    const std::string& text() const
+    {
+        return source;
+    }
+
+  private:
+    struct op_t
+    {
+        char op;
+        char from = 0;
+        char to = 0;
+        std::string name = {};
+    };
+
+    std::string source;
+    std::string prefix;
+    std::string suffix;
+    size_t trim_front = 0;
+    size_t trim_back = 0;
+    std::optional<std::string> extension;
+    std::vector<op_t> directory_ops;
+    // the stem operations in order, for when the folded form does not hold
+    std::vector<op_t> stem_ops;
+    bool folded = true;
+};
+
+/**
+ * @brief Compile rules, one per line, '#' starts a comment line
+ * @throws parse_error naming the line of the first invalid rule
+ */
+std::vector<rule_t> compile_rules(std::string_view text);
+
+/**
+ * @brief Rules for the usual near misses: numbered variants, sibling model,
+ *        texture and material files, normal maps and other locales
+ */
+const std::vector<rule_t>& default_rules();
+
+/**
+ * @brief Apply every rule to every path and keep the hits
+ * @param paths The paths to mutate, a leading '/' is ignored
+ * @param rules The rules to apply
+ * @param targets The hashes to find
+ * @param salt The salt the targets were hashed with
+ * @param options Live reporting, range and checkpoints
+ * @param pool The pool to run on
+ * @return Every target found, each once, in no particular order
+ */
+result_t mutate(std::span<const std::string> paths,
+                std::span<const rule_t> rules, std::span<const hash_t> targets,
+                salt_t salt, const options_t& options = {},
+                util::thread_pool_t& pool = util::default_thread_pool());
+
+} // namespace ssharp::fs::resolver
@@ -13,8 +13,62 @@
 
 #include "ssharpfs.hpp"
 
+#include "cityhash/city.hpp"
+#include "fs/known_paths.hpp"
+#include "util/compressor.hpp"
+#include "util/exceptions.hpp"
+
 namespace ssharp::fs::ssharpfs
 {
+namespace ssexcept = ssharp::exceptions;
+
+void entry_t::compress(compress_type_t type)
+{
+    if (is_encrypted == is_encrypted_t::encrypted)
+    {
+        throw ssexcept::exception("cannot compress an encrypted entry");
+    }
+    if (compress_attr)
+    {
+        if (compress_attr->compress_type == type)
+        {
+            return;
+        }
+        decompress(compress_attr->compress_type);
+    }
+    auto raw = data.get();
+    auto size = raw.size();
+    data = span_t{util::compress(raw, type, file_type())};
+    compress_attr = compress_attr_t{type, size};
+}
+
+void entry_t::decompress(compress_type_t type)
+{
+    if (!compress_attr)
+    {
+        return;
+    }
+    if (is_encrypted == is_encrypted_t::encrypted)
+    {
+        throw ssexcept::exception("cannot decompress an encrypted entry");
+    }
+    if (compress_attr->compress_type != type)
+    {
+        throw ssexcept::exception("entry is compressed with another type");
+    }
+    data = span_t{util::decompress(data.get(), type,
+                                   compress_attr->uncompressed_size)};
+    compress_attr.reset();
+}
+
+hash_t hash_path(std::string_view path, salt_t salt)
+{
+    if (path.starts_with('/'))
+    {
+        path.remove_prefix(1);
+    }
+    return cityhash::CityHash64Salted(salt, path);
+}
 
 parsed_paths_t ssharpfs_t::get_parsed_paths() const
 {
@@ -27,6 +81,154 @@ parsed_paths_t ssharpfs_t::get_parsed_paths() const
         }
         paths.insert(entry->parsed_paths.begin(), entry->parsed_paths.end());
     }
+    return paths;
+}
+
+bool ssharpfs_t::rekey(hash_t hash, std::string_view path)
+{
+    auto it = find(hash_attr_t{hash, salt});
+    if (it == end())
+    {
+        return false;
+    }
+    auto node = extract(it);
+    node.key() = path_t(path);
+    auto inserted = insert(std::move(node));
+    if (!inserted.inserted)
+    {
+        // the path is already taken, keep the entry under its hash
+        inserted.node.key() = hash_attr_t{hash, salt};
+        insert(std::move(inserted.node));
+        return false;
+    }
+    return true;
+}
+
+bool ssharpfs_t::resolve(std::string_view path)
+{
+    return rekey(hash_path(path, salt), path);
+}
+
+void ssharpfs_t::apply_dictionary(const dictionary_t& dictionary)
+{
+    const auto& [dictionary_salt, paths] = dictionary;
+    for (const auto& [hash, path] : paths)
+    {
+        auto name = path.generic_string();
+        // hashes made with another salt are no use here, the path is
+        rekey(dictionary_salt == salt ? hash : hash_path(name, salt), name);
+    }
+}
+
+void ssharpfs_t::apply_known_paths()
+{
+    for (const auto& [path, hash] : known_paths)
+    {
+        // the table is unsalted, salted archives hash at runtime
+        rekey(salt == 0 ? hash : hash_path(path, salt), path);
+    }
+}
+
+resolver::vocabulary_t ssharpfs_t::vocabulary() const
+{
+    resolver::vocabulary_t vocabulary;
+    for (const auto& [key, entry] : *this)
+    {
+        auto is_directory = entry->file_type() == file_type_t::directory;
+        auto base = std::get_if<path_t>(&key);
+        if (base)
+        {
+            vocabulary.add_path(base->generic_string(), is_directory);
+        }
+        for (const auto& [path, is_absolute, is_dir, _] : entry->parsed_paths)
+        {
+            auto dir = is_dir == is_directory_t::directory;
+            if (is_absolute == is_absolute_path_t::absolute)
+            {
+                vocabulary.add_path(path.generic_string(), dir);
+            }
+            else if (base)
+            {
+                // directories list their children, files refer to siblings
+                auto parent = is_directory ? *base : base->parent_path();
+                vocabulary.add_path((parent / path).generic_string(), dir);
+            }
+            else
+            {
+                // where it is relative to is unknown, only the name is useful
+                vocabulary.add_path(path.filename().generic_string(), dir);
+            }
+        }
+    }
+    return vocabulary;
+}
+
+std::vector<hash_t> ssharpfs_t::unresolved() const
+{
+    std::vector<hash_t> hashes;
+    for (const auto& [key, _] : *this)
+    {
+        if (auto hash = std::get_if<hash_attr_t>(&key))
+        {
+            hashes.push_back(hash->first);
+        }
+    }
+    return hashes;
+}
+
+resolver::result_t ssharpfs_t::brute_force(const resolver::options_t& options,
+                                           util::thread_pool_t& pool)
+{
+    auto result = resolver::brute_force(vocabulary(), unresolved(), salt,
+                                        options, pool);
+    for (const auto& [hash, path] : result.hits)
+    {
+        rekey(hash, path);
+    }
+    return result;
+}
+
+std::vector<std::string> ssharpfs_t::mutation_bases() const
+{
+    std::set<std::string> bases;
+    for (const auto& [key, entry] : *this)
+    {
+        auto base = std::get_if<path_t>(&key);
+        if (base)
+        {
+            bases.insert(base->generic_string());
+        }
+        for (const auto& [path, is_absolute, is_dir, _] : entry->parsed_paths)
+        {
+            if (is_absolute == is_absolute_path_t::absolute)
+            {
+                bases.insert(path.generic_string());
+            }
+            else if (base)
+            {
+                // same as vocabulary(), a path relative to an unresolved
+                // entry cannot be placed and is left out
+                auto parent = entry->file_type() == file_type_t::directory
+                                  ? *base
+                                  : base->parent_path();
+                bases.insert((parent / path).generic_string());
+            }
+        }
+    }
+    return {bases.begin(), bases.end()};
+}
+
+resolver::result_t ssharpfs_t::mutate(std::span<const resolver::rule_t> rules,
+                                      const resolver::options_t& options,
+                                      util::thread_pool_t& pool)
+{
+    auto result = resolver::mutate(mutation_bases(), rules, unresolved(), salt,
+                                   options, pool);
+    for (const auto& [hash, path] : result.hits)
+    {
+        rekey(hash, path);
+    }
+    return result;
 }
 
 bool ssharpfs_t::entries_all_resolved() const
@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include "fs/rules.hpp"
 #include "util/span.hpp"
 #include "util/types.hpp"
 #include "parser/directory.hpp"
@@ -29,18 +30,46 @@ using span_t = ssharp::util::span_t;
 
 struct entry_t 
 {
-    is_encrypted_t is_encrypted;
+    explicit entry_t(span_t data) : data(std::move(data))
+    {
+    }
+    virtual ~entry_t() = default;
+
+    is_encrypted_t is_encrypted = is_encrypted_t::decrypted;
     span_t data;
     parsed_paths_t parsed_paths;
     std::optional<compress_attr_t> compress_attr;
     virtual file_type_t file_type() const = 0;
     virtual void parse() {};
+    /**
+     * @brief Replace data by its compressed form, recompressing it if it is
+     *        compressed with another type
+     * @throws exception if the entry is encrypted
+     */
     virtual void compress(compress_type_t type);
+    /**
+     * @brief Replace data by its uncompressed form
+     * @param type The type data is compressed with, must match compress_attr
+     * @throws exception if the entry is encrypted or compressed otherwise
+     */
     virtual void decompress(compress_type_t type);
+
+  protected:
+    // hands the parser a view when the data is resident, a copy otherwise
+    template <typename parser_t>
+    parsed_paths_t parse_with(parser_t&& parser) const
+    {
+        if (auto view = data.view())
+        {
+            return parser(*view);
+        }
+        return parser(data.get());
+    }
 };
 
 struct generic_entry_t : entry_t
 {
+    using entry_t::entry_t;
     file_type_t file_type() const override
     {
         return file_type_t::generic;
@@ -49,6 +78,7 @@ struct generic_entry_t : entry_t
 
 struct sii_entry_t : entry_t
 {
+    using entry_t::entry_t;
     sii_status_t sii_status;    
     file_type_t file_type() const override
     {
@@ -62,18 +92,21 @@ struct sii_entry_t : entry_t
 
 struct directory_entry_t : public entry_t
 {
+    using entry_t::entry_t;
     file_type_t file_type() const override
     {
         return file_type_t::directory;
     }
     void parse() override
     {
-        parsed_paths = parser::directory::parse(data.get());
+        parsed_paths = parse_with(
+            [](buff_view_t buff) { return parser::directory::find_paths(buff); });
     }
 };
 
 struct mat_entry_t : entry_t
 {
+    using entry_t::entry_t;
     file_type_t file_type() const override
     {
         return file_type_t::mat;
@@ -86,18 +119,21 @@ struct mat_entry_t : entry_t
 
 struct pmd_entry_t : entry_t
 {
+    using entry_t::entry_t;
     file_type_t file_type() const override
     {
         return file_type_t::pmd;
     }
     void parse() override
     {
-        parsed_paths = parser::pmd::find_paths(data.get());
+        parsed_paths = parse_with(
+            [](buff_view_t buff) { return parser::pmd::find_paths(buff); });
     }
 };
 
 struct tobj_entry_t : entry_t
 {
+    using entry_t::entry_t;
     file_type_t file_type() const override
     {
         return file_type_t::tobj;
@@ -110,16 +146,25 @@ struct tobj_entry_t : entry_t
 
 struct soundref_entry_t : entry_t
 {
+    using entry_t::entry_t;
     file_type_t file_type() const override
     {
         return file_type_t::soundref;
     }
     void parse() override
     {
-        parsed_paths = parser::soundref::parse(data.get());
+        parsed_paths = parse_with(
+            [](buff_view_t buff) { return parser::soundref::find_paths(buff); });
     }
 };
 
+/**
+ * @brief The hash an archive salted with salt stores for a path
+ * @param path The path, a leading '/' is ignored
+ * @note Does not allocate, see cityhash::CityHash64Salted
+ */
+hash_t hash_path(std::string_view path, salt_t salt);
+
 struct ssharpfs_t : std::map<entry_key_t, std::shared_ptr<entry_t>>
 {
     using std::map<entry_key_t, std::shared_ptr<entry_t>>::map;
@@ -127,8 +172,46 @@ struct ssharpfs_t : std::map<entry_key_t, std::shared_ptr<entry_t>>
     void prune_directories(path_t root = path_t(""));
     parsed_paths_t get_parsed_paths() const;
     void apply_dictionary(const dictionary_t& dictionary);
+    /**
+     * @brief Resolve every entry whose hash is in known_paths
+     */
+    void apply_known_paths();
     bool entries_all_resolved() const;
+    /**
+     * @brief Key the entry stored under the hash of path by path instead
+     * @return true if an unresolved entry matched and path was not taken
+     */
+    bool resolve(std::string_view path);
+    /**
+     * @brief Directory names, stems and extensions of every path known so far,
+     *        from resolved entries and from parsed paths
+     */
+    resolver::vocabulary_t vocabulary() const;
+    /**
+     * @brief Brute force the unresolved entries from vocabulary()
+     * @return The hits, which are resolved in this archive on return
+     */
+    resolver::result_t brute_force(
+        const resolver::options_t& options = {},
+        util::thread_pool_t& pool = util::default_thread_pool());
+    /**
+     * @brief The resolved paths and the parsed paths that can be placed,
+     *        what mutate() applies the rules to
+     */
+    std::vector<std::string> mutation_bases() const;
+    /**
+     * @brief Apply rules to mutation_bases(), then resolve hits
+     * @return The hits, which are resolved in this archive on return
+     */
+    resolver::result_t mutate(
+        std::span<const resolver::rule_t> rules = resolver::default_rules(),
+        const resolver::options_t& options = {},
+        util::thread_pool_t& pool = util::default_thread_pool());
     salt_t salt = 0;
+
+  private:
+    bool rekey(hash_t hash, std::string_view path);
+    std::vector<hash_t> unresolved() const;
 };
 
 } // namespace ssharp::fs::ssharpfs
\ No newline at end of file
@@ -27,7 +27,7 @@ using namespace ssharp::types;
  * @return A set of paths
  * @throws parse_error if the file is invalid
  */
-parsed_paths_t find_paths(const buff_t& buff,
+parsed_paths_t find_paths(buff_view_t buff,
                           std::optional<hash_attr_t> hash = std::nullopt);
 
 } // namespace ssharp::parser::directory
@@ -20,7 +20,7 @@ namespace ssharp::parser::pmd
 
 namespace ssexcept = ssharp::exceptions;
 
-parsed_paths_t find_paths(const buff_t& buff, std::optional<hash_attr_t> hash)
+parsed_paths_t find_paths(buff_view_t buff, std::optional<hash_attr_t> hash)
 {
     // Check if the buffer is large enough to contain the header
     if (buff.size() < sizeof(header_t))
@@ -22,7 +22,7 @@ namespace ssharp::parser::sii
     
 namespace ssexcept = ssharp::exceptions;
 
-buff_t crlf_to_lf(const buff_t& buff)
+buff_t crlf_to_lf(buff_view_t buff)
 {
     try
     {
@@ -38,7 +38,7 @@ buff_t crlf_to_lf(const buff_t& buff)
     }
 }
 
-buff_t remove_comments(const buff_t& buff)
+buff_t remove_comments(buff_view_t buff)
 {
     // commend start with '#' and end with '\n'
     static const std::regex re{R"(^\s*#.*)"};
@@ -48,7 +48,7 @@ buff_t remove_comments(const buff_t& buff)
     return buff_t{result.begin(), result.end()};
 }
 
-buff_t remove_empty_lines(const buff_t& buff)
+buff_t remove_empty_lines(buff_view_t buff)
 {
     static const std::regex re{R"(^\s*$\n?)"};
     std::string buff_str{buff.begin(), buff.end()};
@@ -57,7 +57,7 @@ buff_t remove_empty_lines(const buff_t& buff)
     return buff_t{result.begin(), result.end()};
 }
 
-buff_t remove_newline_behind_colon(const buff_t& buff)
+buff_t remove_newline_behind_colon(buff_view_t buff)
 {
     static const std::regex re{R"(:\s*\n\s*)"};
     std::string buff_str{buff.begin(), buff.end()};
@@ -66,7 +66,7 @@ buff_t remove_newline_behind_colon(const buff_t& buff)
     return buff_t{result.begin(), result.end()};
 }
 
-buff_t remove_whitespace(const buff_t& buff)
+buff_t remove_whitespace(buff_view_t buff)
 {
     static const std::regex re{R"([ \t\f\v]+)"};
     std::string buff_str{buff.begin(), buff.end()};
@@ -75,7 +75,7 @@ buff_t remove_whitespace(const buff_t& buff)
     return buff_t{result.begin(), result.end()};
 }
 
-parsed_paths_t find_paths(const buff_t& buff, std::optional<hash_attr_t> hash)
+parsed_paths_t find_paths(buff_view_t buff, std::optional<hash_attr_t> hash)
 {
     buff_t result = crlf_to_lf(buff);
     result = remove_comments(result);
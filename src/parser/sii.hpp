@@ -20,11 +20,11 @@ namespace ssharp::parser::sii
 
 using namespace ssharp::types;
 
-buff_t crlf_to_lf(const buff_t& buff);
-buff_t remove_comments(const buff_t& buff);
-buff_t remove_empty_lines(const buff_t& buff);
-buff_t remove_newline_behind_colon(const buff_t& buff);
-buff_t remove_whitespace(const buff_t& buff);
+buff_t crlf_to_lf(buff_view_t buff);
+buff_t remove_comments(buff_view_t buff);
+buff_t remove_empty_lines(buff_view_t buff);
+buff_t remove_newline_behind_colon(buff_view_t buff);
+buff_t remove_whitespace(buff_view_t buff);
 
 /**
  * @brief Parse a buffer containing a sii file
@@ -33,7 +33,7 @@ buff_t remove_whitespace(const buff_t& buff);
  * @return A set of paths
  * @throws parse_error if the file is invalid
  */
-parsed_paths_t find_paths(const buff_t& buff,
+parsed_paths_t find_paths(buff_view_t buff,
                           std::optional<hash_attr_t> hash = std::nullopt);
 
 } // namespace ssharp::parser::sii
\ No newline at end of file
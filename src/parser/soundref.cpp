@@ -22,7 +22,7 @@ namespace ssharp::parser::soundref
 
 namespace ssexcept = ssharp::exceptions;
 
-parsed_paths_t find_paths(const buff_t& buff, std::optional<hash_attr_t> hash)
+parsed_paths_t find_paths(buff_view_t buff, std::optional<hash_attr_t> hash)
 {
     size_t bom_offset = 0;
     if (buff.size() >= 3 && buff[0] == '\xEF' && buff[1] == '\xBB' && buff[2] == '\xBF')
@@ -20,7 +20,7 @@ namespace ssharp::parser::tobj
 
 namespace ssexcept = ssharp::exceptions;
 
-parsed_paths_t find_paths(const buff_t& buff, std::optional<hash_attr_t> hash)
+parsed_paths_t find_paths(buff_view_t buff, std::optional<hash_attr_t> hash)
 {
     if (buff.size() < sizeof(header_t) + sizeof(texture_attr_t))
     {
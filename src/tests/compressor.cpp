@@ -0,0 +1,104 @@
+// Copyright (C) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// zstd decompression does not size its output from a forged frame header
+// and decodes every frame of a concatenated input.
+
+#include "util/compressor.hpp"
+#include "util/exceptions.hpp"
+
+#include <cstdio>
+#include <exception>
+
+using namespace ssharp;
+using namespace ssharp::types;
+
+namespace
+{
+
+// the frame with its content size field widened to 8 bytes and set to size
+buff_t forge_content_size(const buff_t& frame, uint64_t size)
+{
+    constexpr size_t magic_size = 4;
+    constexpr uint8_t fcs_sizes[] = {0, 2, 4, 8};
+    constexpr uint8_t dict_id_sizes[] = {0, 1, 2, 4};
+    uint8_t descriptor = frame[magic_size];
+    bool single_segment = descriptor & 0x20;
+    size_t fcs_size = fcs_sizes[descriptor >> 6];
+    if (fcs_size == 0 && single_segment)
+        fcs_size = 1;
+    size_t header_size = magic_size + 1 + (single_segment ? 0 : 1) +
+                         dict_id_sizes[descriptor & 0b11] + fcs_size;
+
+    buff_t forged(frame.begin(), frame.begin() + header_size - fcs_size);
+    forged[magic_size] = static_cast<uint8_t>(descriptor | 0xC0);
+    for (int i = 0; i < 8; i++)
+        forged.push_back(static_cast<uint8_t>(size >> (i * 8)));
+    forged.insert(forged.end(), frame.begin() + header_size, frame.end());
+    return forged;
+}
+
+bool forged_header_is_rejected()
+{
+    auto& zstd = util::thread_zstd_context();
+    buff_t zeros(1 << 20);
+    auto forged = forge_content_size(zstd.compress(zeros), uint64_t{1} << 50);
+    try
+    {
+        zstd.decompress(forged);
+    }
+    catch (const exceptions::exception&)
+    {
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        std::fprintf(stderr, "forged header: %s\n", e.what());
+        return false;
+    }
+    std::fprintf(stderr, "forged header: decompressed\n");
+    return false;
+}
+
+bool concatenated_frames_are_decoded()
+{
+    auto& zstd = util::thread_zstd_context();
+    buff_t first(1000, 'a');
+    buff_t second(3000, 'b');
+    auto data = zstd.compress(first);
+    auto frame = zstd.compress(second);
+    data.insert(data.end(), frame.begin(), frame.end());
+
+    buff_t expected = first;
+    expected.insert(expected.end(), second.begin(), second.end());
+    try
+    {
+        if (zstd.decompress(data) == expected)
+            return true;
+        std::fprintf(stderr, "concatenated frames: wrong output\n");
+    }
+    catch (const std::exception& e)
+    {
+        std::fprintf(stderr, "concatenated frames: %s\n", e.what());
+    }
+    return false;
+}
+
+} // namespace
+
+int main()
+{
+    bool passed = forged_header_is_rejected();
+    passed = concatenated_frames_are_decoded() && passed;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,80 @@
+// Copyright (C) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// verify reports entries whose data lies past the end of the archive
+// instead of throwing.
+
+#include "fs/hashfs.hpp"
+#include "util/compressor.hpp"
+
+#include <cstdio>
+
+using namespace ssharp;
+using namespace ssharp::types;
+namespace hashfs = ssharp::fs::hashfs;
+
+namespace
+{
+
+template <typename T> void append(buff_t& buff, const T& value)
+{
+    auto bytes = reinterpret_cast<const uint8_t*>(&value);
+    buff.insert(buff.end(), bytes, bytes + sizeof(T));
+}
+
+} // namespace
+
+int main()
+{
+    const buff_t payload{'h', 'e', 'l', 'l', 'o'};
+    const auto size = static_cast<uint32_t>(payload.size());
+    constexpr uint64_t data_offset =
+        sizeof(hashfs::header_t) + 2 * sizeof(hashfs::entry_t);
+
+    hashfs::header_t header{};
+    header.signature = hashfs::expected_signature;
+    header.version = hashfs::expected_version;
+    header.method = hashfs::expected_method;
+    header.entries_count = 2;
+    header.offset = sizeof(hashfs::header_t);
+
+    hashfs::entry_t stored{1, data_offset, hashfs::flags_t{0},
+                           util::crc32(payload), size, size};
+    hashfs::entry_t past_eof{2, data_offset + (1 << 20), hashfs::flags_t{0},
+                             util::crc32(payload), size, size};
+
+    buff_t archive;
+    append(archive, header);
+    append(archive, stored);
+    append(archive, past_eof);
+    archive.insert(archive.end(), payload.begin(), payload.end());
+
+    util::thread_pool_t pool(2);
+    std::vector<hash_t> failed;
+    try
+    {
+        failed = hashfs::verify(util::span_t{std::move(archive)}, true, pool);
+    }
+    catch (const std::exception& e)
+    {
+        std::fprintf(stderr, "verify threw: %s\n", e.what());
+        return 1;
+    }
+    if (failed != std::vector<hash_t>{past_eof.hash})
+    {
+        std::fprintf(stderr, "verify reported %zu failed entries\n",
+                     failed.size());
+        return 1;
+    }
+    return 0;
+}
@@ -14,49 +14,115 @@
 #include "util/compressor.hpp"
 
 #include "ssharp-cli.hpp"
+#include "util/file_type.hpp"
 #include "util/span.hpp"
+#include "util/zstd_dictionary.hpp"
+
+#include <filesystem>
 
 namespace ssharp::cli
 {
 namespace compressor
 {
 using namespace ssharp::types;
-void compress(const std::vector<std::string>& paths, const std::string& type)
+namespace
+{
+// sample files grouped by file type, directories are walked recursively
+std::map<file_type_t, std::vector<buff_t>> collect_samples(
+    const std::vector<std::string>& paths)
+{
+    std::map<file_type_t, std::vector<buff_t>> corpus;
+    auto add_sample = [&](const path_t& path) {
+        corpus[util::file_type_of(path)].push_back(*util::span_t(path));
+    };
+    for (const auto& path : paths)
+    {
+        if (!std::filesystem::is_directory(path))
+        {
+            add_sample(path);
+            continue;
+        }
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(path))
+        {
+            if (entry.is_regular_file())
+                add_sample(entry.path());
+        }
+    }
+    return corpus;
+}
+std::optional<compress_type_t> parse_type(const std::string& type)
 {
-    compress_type_t ctype;
     if (type == "zlib")
-        ctype = compress_type_t::zlib;
-    else if (type == "gzip")
-        ctype = compress_type_t::gzip;
-    else if (type == "raw")
-        ctype = compress_type_t::raw;
-    else
+        return compress_type_t::zlib;
+    if (type == "gzip")
+        return compress_type_t::gzip;
+    if (type == "raw")
+        return compress_type_t::raw;
+    if (type == "zstd")
+        return compress_type_t::zstd;
+    return std::nullopt;
+}
+} // namespace
+void compress(const std::vector<std::string>& paths, const std::string& type,
+              const std::string& dictionaries, size_t jobs,
+              const std::string& profile)
+{
+    auto parsed = parse_type(type);
+    if (!parsed)
     {
         std::cerr << "Invalid compression type" << std::endl;
         return;
     }
+    auto ctype = *parsed;
+    util::compress_profile_t cprofile;
+    if (profile == "fast")
+        cprofile = util::compress_profile_t::fast;
+    else if (profile == "normal")
+        cprofile = util::compress_profile_t::normal;
+    else if (profile == "max")
+        cprofile = util::compress_profile_t::max_ratio;
+    else
+    {
+        std::cerr << "Invalid compression profile" << std::endl;
+        return;
+    }
+    auto options = util::profile_options(cprofile, ctype);
+    if (!dictionaries.empty())
+        util::register_zstd_dictionaries(util::load_zstd_dictionaries(dictionaries));
+    // zstd runs its own workers
+    std::optional<util::thread_pool_t> pool;
+    if (jobs > 1 && ctype != compress_type_t::zstd)
+        pool.emplace(jobs);
     for (const auto& path : paths)
     {
         auto data = *util::span_t(path);
-        auto compressed = util::compress(data, ctype);
+        auto file_type = util::file_type_of(path);
+        buff_t compressed;
+        if (jobs > 1 && ctype == compress_type_t::zstd)
+            compressed = util::thread_zstd_context().compress(
+                data, options.level.value_or(util::zstd_context_t::default_level),
+                static_cast<unsigned int>(jobs),
+                util::find_zstd_dictionary(file_type).get());
+        else if (pool)
+            compressed = util::compress_parallel(data, ctype, *pool, 1024 * 1024, options);
+        else
+            compressed = util::compress(data, ctype, file_type, options);
         std::ofstream ofs(path + ".compressed", std::ios::binary);
         ofs.write(reinterpret_cast<const char*>(compressed.data()), compressed.size());
     }
 }
-void decompress(const std::vector<std::string>& paths, const std::string& type)
+void decompress(const std::vector<std::string>& paths, const std::string& type,
+                const std::string& dictionaries)
 {
-    compress_type_t ctype;
-    if (type == "zlib")
-        ctype = compress_type_t::zlib;
-    else if (type == "gzip")
-        ctype = compress_type_t::gzip;
-    else if (type == "raw")
-        ctype = compress_type_t::raw;
-    else
+    auto parsed = parse_type(type);
+    if (!parsed)
     {
         std::cerr << "Invalid compression type" << std::endl;
         return;
     }
+    auto ctype = *parsed;
+    if (!dictionaries.empty())
+        util::register_zstd_dictionaries(util::load_zstd_dictionaries(dictionaries));
     for (const auto& path : paths)
     {
         auto data = *util::span_t(path);
@@ -65,9 +131,67 @@ void decompress(const std::vector<std::string>& paths, const std::string& type)
         ofs.write(reinterpret_cast<const char*>(decompressed.data()), decompressed.size());
     }
 }
+void train(const std::vector<std::string>& paths, const std::string& output,
+           size_t capacity)
+{
+    auto corpus = collect_samples(paths);
+    auto dictionaries = util::train_zstd_dictionaries(corpus, capacity);
+    for (const auto& [file_type, samples] : corpus)
+    {
+        auto it = dictionaries.find(file_type);
+        std::cout << "type " << static_cast<int>(file_type) << ": "
+                  << samples.size() << " samples, ";
+        if (it == dictionaries.end())
+            std::cout << "not enough to train" << std::endl;
+        else
+            std::cout << it->second->content().size() << " bytes, id "
+                      << it->second->id() << std::endl;
+    }
+    util::save_zstd_dictionaries(dictionaries, output);
+}
+void transcode(const std::vector<std::string>& paths, const std::string& from,
+               const std::string& to)
+{
+    auto from_type = parse_type(from);
+    auto to_type = parse_type(to);
+    if (!from_type || !to_type || *from_type == compress_type_t::zstd ||
+        *to_type == compress_type_t::zstd)
+    {
+        std::cerr << "Invalid compression type, expected zlib, gzip or raw"
+                  << std::endl;
+        return;
+    }
+    for (const auto& path : paths)
+    {
+        auto data = *util::span_t(path);
+        auto transcoded = util::transcode(data, *from_type, *to_type);
+        std::ofstream ofs(path + ".transcoded", std::ios::binary);
+        ofs.write(reinterpret_cast<const char*>(transcoded.data()), transcoded.size());
+    }
+}
+void tune(const std::vector<std::string>& paths, const std::string& type,
+          double budget)
+{
+    auto ctype = parse_type(type);
+    if (!ctype)
+    {
+        std::cerr << "Invalid compression type" << std::endl;
+        return;
+    }
+    auto tuned = util::tune_compression(collect_samples(paths), *ctype, budget);
+    for (const auto& [file_type, result] : tuned)
+    {
+        std::cout << "type " << static_cast<int>(file_type) << ": level "
+                  << result.options.level.value_or(-1) << ", strategy "
+                  << static_cast<int>(result.options.strategy) << ", mem level "
+                  << result.options.mem_level << ", ratio " << result.ratio
+                  << ", " << result.ms_per_mib << " ms/MiB" << std::endl;
+    }
+}
 } // namespace compressor
 void add_compress_sub_command(CLI::App& app, std::vector<std::string>& paths,
-                              std::string& type)
+                              std::string& type, std::string& dictionaries,
+                              size_t& jobs, std::string& profile)
 {
     auto compress = app.add_subcommand("compress", "Compress files");
     compress->add_option("paths", paths, "Paths to compress")
@@ -76,10 +200,21 @@ void add_compress_sub_command(CLI::App& app, std::vector<std::string>& paths,
     compress->add_option("-t,--type", type, "Compression type")
         ->required()
         ->type_name("TYPE");
-    compress->callback([&]() { compressor::compress(paths, type); });
+    compress->add_option("-d,--dictionaries", dictionaries,
+                         "zstd dictionaries to compress with, by file type")
+        ->type_name("PATH");
+    compress->add_option("-j,--jobs", jobs,
+                         "Compress each file in blocks on this many threads")
+        ->type_name("N");
+    compress->add_option("-p,--profile", profile,
+                         "fast, normal or max (ratio)")
+        ->type_name("PROFILE");
+    compress->callback([&]() {
+        compressor::compress(paths, type, dictionaries, jobs, profile);
+    });
 }
 void add_decompress_sub_command(CLI::App& app, std::vector<std::string>& paths,
-                                std::string& type)
+                                std::string& type, std::string& dictionaries)
 {
     auto decompress = app.add_subcommand("decompress", "Decompress files");
     decompress->add_option("paths", paths, "Paths to decompress")
@@ -88,6 +223,55 @@ void add_decompress_sub_command(CLI::App& app, std::vector<std::string>& paths,
     decompress->add_option("-t,--type", type, "Compression type")
         ->required()
         ->type_name("TYPE");
-    decompress->callback([&]() { compressor::decompress(paths, type); });
+    decompress->add_option("-d,--dictionaries", dictionaries,
+                           "zstd dictionaries the data was compressed with")
+        ->type_name("PATH");
+    decompress->callback([&]() { compressor::decompress(paths, type, dictionaries); });
+}
+void add_train_dict_sub_command(CLI::App& app, std::vector<std::string>& paths,
+                                std::string& output, size_t& capacity)
+{
+    auto train = app.add_subcommand("train-dict",
+                                    "Train zstd dictionaries per file type");
+    train->add_option("paths", paths, "Sample files or directories")
+        ->required()
+        ->type_name("PATHS");
+    train->add_option("-o,--output", output, "Dictionaries file to write")
+        ->required()
+        ->type_name("PATH");
+    train->add_option("-s,--size", capacity, "Maximum size of each dictionary")
+        ->type_name("BYTES");
+    train->callback([&]() { compressor::train(paths, output, capacity); });
+}
+void add_transcode_sub_command(CLI::App& app, std::vector<std::string>& paths,
+                               std::string& from, std::string& to)
+{
+    auto transcode = app.add_subcommand(
+        "transcode", "Re-wrap deflate data as zlib, gzip or raw without recompressing");
+    transcode->add_option("paths", paths, "Paths to transcode")
+        ->required()
+        ->type_name("PATHS");
+    transcode->add_option("-f,--from", from, "Container of the input")
+        ->required()
+        ->type_name("TYPE");
+    transcode->add_option("-t,--to", to, "Container to write")
+        ->required()
+        ->type_name("TYPE");
+    transcode->callback([&]() { compressor::transcode(paths, from, to); });
+}
+void add_tune_sub_command(CLI::App& app, std::vector<std::string>& paths,
+                          std::string& type, double& budget)
+{
+    auto tune = app.add_subcommand(
+        "tune", "Pick compression settings per file type under a time budget");
+    tune->add_option("paths", paths, "Sample files or directories")
+        ->required()
+        ->type_name("PATHS");
+    tune->add_option("-t,--type", type, "Compression type")
+        ->required()
+        ->type_name("TYPE");
+    tune->add_option("-b,--budget", budget, "Compression time allowed per MiB")
+        ->type_name("MS");
+    tune->callback([&]() { compressor::tune(paths, type, budget); });
 }
 } // namespace ssharp::cli
@@ -23,25 +23,21 @@ namespace hash
 using namespace ssharp::types;
 void hash(const std::vector<std::string>& strs, uint16_t salt, bool verbose)
 {
-    for (auto str : strs)
+    for (const auto& str : strs)
     {
-        hash_t hash;
-        if(salt)
-        {
-            str = std::to_string(salt) + str;
-        }
-        hash = cityhash::CityHash64(str);
+        hash_t hash = cityhash::CityHash64Salted(salt, str);
         if (verbose)
         {
-            std::cout << "Length: " << str.size() << std::endl;
-            std::cout << "Hash of \"" << str << "\": " << std::endl;
+            auto salted = salt ? std::to_string(salt) + str : str;
+            std::cout << "Length: " << salted.size() << std::endl;
+            std::cout << "Hash of \"" << salted << "\": " << std::endl;
         }
         std::cout << std::hex << hash << std::endl;
     }
 }
 } // namespace hash
 void add_hash_sub_command(CLI::App& app, std::vector<std::string>& strs,
-                            uint8_t& salt, bool& verbose)
+                            uint16_t& salt, bool& verbose)
 {
     auto hash = app.add_subcommand("hash", "Hash a string");
     hash->add_option("--salt,-s", salt, "Specify the salt to use");
@@ -23,11 +23,24 @@ int main(int argc, char** argv)
     std::string type;
     cli::add_parser_sub_command(app, paths, type);
     std::vector<std::string> strs;
-    uint8_t salt = 0;
+    uint16_t salt = 0;
     bool verbose = false;
     cli::add_hash_sub_command(app, strs, salt, verbose);
-    cli::add_compress_sub_command(app, paths, type);
-    cli::add_decompress_sub_command(app, paths, type);
+    std::string dictionaries;
+    size_t jobs = 1;
+    std::string profile = "normal";
+    cli::add_compress_sub_command(app, paths, type, dictionaries, jobs, profile);
+    cli::add_decompress_sub_command(app, paths, type, dictionaries);
+    std::string output;
+    size_t capacity = 112640;
+    cli::add_train_dict_sub_command(app, paths, output, capacity);
+    std::string from;
+    cli::add_transcode_sub_command(app, paths, from, type);
+    double budget = 50;
+    cli::add_tune_sub_command(app, paths, type, budget);
+    cli::resolver::resolve_args_t resolve_args;
+    cli::add_resolve_sub_command(app, paths, resolve_args);
+    cli::add_resolve_merge_sub_command(app, paths, output);
     CLI11_PARSE(app, argc, argv);
     return 0;
 }
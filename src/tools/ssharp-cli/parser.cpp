@@ -31,49 +31,42 @@ void parse(const std::vector<std::string>& paths, const std::string& type)
     using span_t = ssharp::util::span_t;
     using namespace ssharp::types;
     parsed_paths_t parsed_paths;
-    if (type == "pmd")
-    {
+    // parse straight out of a mapping instead of reading each file
+    auto parse_each = [&](auto&& find_paths) {
         for (const auto& path : paths)
         {
-            auto result = pmd::find_paths(*span_t{path});
+            span_t span{util::map_file(path)};
+            auto result = find_paths(*span.view());
             parsed_paths.insert(result.begin(), result.end());
         }
+    };
+    if (type == "pmd")
+    {
+        parse_each([](buff_view_t buff) { return pmd::find_paths(buff); });
     }
     else if (type == "soundref")
     {
-        for (const auto& path : paths)
-        {
-            auto data = *span_t{path};
-            auto result = ssharp::parser::soundref::find_paths(data);
-            parsed_paths.insert(result.begin(), result.end());
-        }
+        parse_each([](buff_view_t buff) {
+            return ssharp::parser::soundref::find_paths(buff);
+        });
     }
     else if (type == "font")
     {
-        for (const auto& path : paths)
-        {
-            auto data = *span_t{path};
-            auto result = ssharp::parser::font::find_paths(data);
-            parsed_paths.insert(result.begin(), result.end());
-        }
+        parse_each([](buff_view_t buff) {
+            return ssharp::parser::font::find_paths(buff);
+        });
     }
     else if (type == "tobj")
     {
-        for (const auto& path : paths)
-        {
-            auto data = *span_t{path};
-            auto result = ssharp::parser::tobj::find_paths(data);
-            parsed_paths.insert(result.begin(), result.end());
-        }
+        parse_each([](buff_view_t buff) {
+            return ssharp::parser::tobj::find_paths(buff);
+        });
     }
     else if (type == "sii")
     {
-        for (const auto& path : paths)
-        {
-            auto data = *span_t{path};
-            auto result = ssharp::parser::sii::find_paths(data);
-            parsed_paths.insert(result.begin(), result.end());
-        }
+        parse_each([](buff_view_t buff) {
+            return ssharp::parser::sii::find_paths(buff);
+        });
     }
     else
     {
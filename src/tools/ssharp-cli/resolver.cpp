@@ -0,0 +1,342 @@
+// Copyright (C) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fs/hashfs.hpp"
+#include "fs/rules.hpp"
+#include "util/exceptions.hpp"
+
+#include "ssharp-cli.hpp"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace ssharp::cli
+{
+namespace resolver
+{
+using namespace ssharp::types;
+namespace fsr = ssharp::fs::resolver;
+namespace fss = ssharp::fs::ssharpfs;
+namespace hashfs = ssharp::fs::hashfs;
+namespace
+{
+// one hexadecimal hash per line, anything else is skipped
+std::vector<hash_t> read_hashes(const std::vector<std::string>& paths)
+{
+    std::vector<hash_t> hashes;
+    for (const auto& path : paths)
+    {
+        std::ifstream ifs(path);
+        std::string line;
+        while (std::getline(ifs, line))
+        {
+            try
+            {
+                hashes.push_back(std::stoull(line, nullptr, 16));
+            }
+            catch (const std::logic_error&)
+            {
+            }
+        }
+    }
+    return hashes;
+}
+// one path per line, a trailing '/' marks a directory
+std::vector<std::string> read_words(const std::vector<std::string>& paths)
+{
+    std::vector<std::string> words;
+    for (const auto& path : paths)
+    {
+        std::ifstream ifs(path);
+        std::string line;
+        while (std::getline(ifs, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if (!line.empty())
+                words.push_back(std::move(line));
+        }
+    }
+    return words;
+}
+fsr::vocabulary_t make_vocabulary(const std::vector<std::string>& words)
+{
+    fsr::vocabulary_t vocabulary;
+    for (std::string_view word : words)
+    {
+        auto is_directory = word.ends_with('/');
+        if (is_directory)
+            word.remove_suffix(1);
+        vocabulary.add_path(word, is_directory);
+    }
+    return vocabulary;
+}
+std::vector<fsr::rule_t> read_rules(const std::string& rules)
+{
+    if (rules == "default")
+        return fsr::default_rules();
+    std::ifstream ifs(rules);
+    std::stringstream text;
+    text << ifs.rdbuf();
+    return fsr::compile_rules(text.str());
+}
+void print_hit(hash_t hash, std::string_view path)
+{
+    std::cout << std::hex << std::setw(16) << std::setfill('0') << hash
+              << std::dec << ' ' << path << std::endl;
+}
+void print_result(const fsr::result_t& result, size_t targets,
+                  const util::thread_pool_t& pool)
+{
+    std::cerr << '\r' << result.hits.size() << " of " << targets
+              << " resolved, " << result.progress.candidates << " hashes in "
+              << std::fixed << std::setprecision(2)
+              << result.progress.elapsed.count() << " s, "
+              << std::setprecision(1) << result.progress.rate() / 1e6
+              << " MH/s on " << pool.size() << " threads" << std::endl;
+}
+// directories list the names of their children, the rest is not parsed yet
+void parse_directories(fss::ssharpfs_t& fs)
+{
+    for (auto& [key, entry] : fs)
+    {
+        if (entry->file_type() != file_type_t::directory ||
+            entry->is_encrypted == is_encrypted_t::encrypted)
+            continue;
+        try
+        {
+            if (entry->compress_attr)
+                entry->decompress(entry->compress_attr->compress_type);
+            entry->parse();
+        }
+        catch (const exceptions::exception&)
+        {
+            // a corrupt listing only loses its names
+        }
+    }
+}
+size_t count_unresolved(const fss::ssharpfs_t& fs)
+{
+    return std::ranges::count_if(fs, [](const auto& item) {
+        return std::holds_alternative<hash_attr_t>(item.first);
+    });
+}
+// brute forces the names the archive knows, or mutates its paths with rules
+void resolve_archive(const std::string& archive,
+                     const std::vector<std::string>& words,
+                     std::span<const fsr::rule_t> rules,
+                     const resolve_args_t& args, fsr::options_t options,
+                     util::thread_pool_t& pool)
+{
+    auto fs = hashfs::parse(util::span_t{path_t(archive)});
+    parse_directories(fs);
+    fs.apply_known_paths();
+    dictionary_t dictionary{fs.salt, {}};
+    for (std::string_view word : words)
+    {
+        if (word.ends_with('/'))
+            word.remove_suffix(1);
+        dictionary.second.emplace(fss::hash_path(word, fs.salt), path_t(word));
+    }
+    fs.apply_dictionary(dictionary);
+
+    auto [index, count] = args.shard;
+    // hits place more parsed paths, so search again with them, unless the
+    // search is split or checkpointed and has to stay the same
+    auto repeat = count == 1 && args.checkpoint.empty();
+    std::cerr << archive << ": " << fs.size() << " entries, salt " << fs.salt
+              << std::endl;
+    for (auto targets = count_unresolved(fs); targets > 0;)
+    {
+        fsr::result_t result;
+        if (rules.empty())
+        {
+            auto vocabulary = fs.vocabulary();
+            std::cerr << targets << " hashes, " << vocabulary.directories.size()
+                      << " directories x " << vocabulary.stems.size()
+                      << " stems x " << vocabulary.extensions.size()
+                      << " extensions = " << vocabulary.candidates()
+                      << " candidates" << std::endl;
+            options.range = fsr::shard(vocabulary.candidates(), index, count);
+            result = fs.brute_force(options, pool);
+        }
+        else
+        {
+            auto bases = fs.mutation_bases().size();
+            std::cerr << targets << " hashes, " << bases << " paths x "
+                      << rules.size() << " rules" << std::endl;
+            options.range = fsr::shard(bases * rules.size(), index, count);
+            result = fs.mutate(rules, options, pool);
+        }
+        print_result(result, targets, pool);
+        auto left = count_unresolved(fs);
+        if (!repeat || left == targets)
+            break;
+        targets = left;
+    }
+    std::cerr << archive << ": " << fs.size() - count_unresolved(fs) << " of "
+              << fs.size() << " entries resolved" << std::endl;
+}
+void resolve_hash_lists(const std::vector<std::string>& hashes,
+                        const resolve_args_t& args, fsr::options_t options,
+                        util::thread_pool_t& pool)
+{
+    auto targets = read_hashes(hashes);
+    auto paths = read_words(args.words);
+    auto [index, count] = args.shard;
+    fsr::result_t result;
+    if (args.rules.empty())
+    {
+        auto vocabulary = make_vocabulary(paths);
+        std::cerr << targets.size() << " hashes, " << vocabulary.directories.size()
+                  << " directories x " << vocabulary.stems.size() << " stems x "
+                  << vocabulary.extensions.size() << " extensions = "
+                  << vocabulary.candidates() << " candidates" << std::endl;
+        options.range = fsr::shard(vocabulary.candidates(), index, count);
+        result = fsr::brute_force(vocabulary, targets, args.salt, options, pool);
+    }
+    else
+    {
+        auto compiled = read_rules(args.rules);
+        std::cerr << targets.size() << " hashes, " << paths.size() << " paths x "
+                  << compiled.size() << " rules" << std::endl;
+        options.range = fsr::shard(paths.size() * compiled.size(), index, count);
+        result = fsr::mutate(paths, compiled, targets, args.salt, options, pool);
+    }
+    print_result(result, targets.size(), pool);
+}
+} // namespace
+void resolve(const std::vector<std::string>& inputs, const resolve_args_t& args)
+{
+    fsr::options_t options;
+    options.on_hit = print_hit;
+    options.on_progress = [](const fsr::progress_t& progress) {
+        std::cerr << '\r' << progress.candidates << '/' << progress.total << ", "
+                  << std::fixed << std::setprecision(1) << progress.rate() / 1e6
+                  << " MH/s, " << progress.hits << " hits" << std::flush;
+    };
+    options.checkpoint = args.checkpoint;
+    options.resume = args.resume;
+    auto [index, count] = args.shard;
+    if (count == 0 || index >= count)
+    {
+        std::cerr << "Invalid shard " << index << " of " << count << std::endl;
+        return;
+    }
+    util::thread_pool_t pool{args.threads};
+    if (args.hash_lists)
+    {
+        if (args.words.empty())
+        {
+            std::cerr << "Hash lists need --words" << std::endl;
+            return;
+        }
+        resolve_hash_lists(inputs, args, options, pool);
+        return;
+    }
+    if (!args.checkpoint.empty() && inputs.size() > 1)
+    {
+        std::cerr << "A checkpoint holds the search of a single archive"
+                  << std::endl;
+        return;
+    }
+    auto words = read_words(args.words);
+    std::vector<fsr::rule_t> rules;
+    if (!args.rules.empty())
+    {
+        rules = read_rules(args.rules);
+        if (rules.empty())
+        {
+            std::cerr << "No rules in " << args.rules << std::endl;
+            return;
+        }
+    }
+    for (const auto& archive : inputs)
+    {
+        resolve_archive(archive, words, rules, args, options, pool);
+    }
+}
+void merge(const std::vector<std::string>& checkpoints, const std::string& output)
+{
+    std::vector<fsr::checkpoint_t> loaded;
+    for (const auto& path : checkpoints)
+    {
+        loaded.push_back(fsr::load_checkpoint(path));
+        const auto& checkpoint = loaded.back();
+        if (checkpoint.cursor != checkpoint.range.end)
+        {
+            std::cerr << path << ": unfinished, at " << checkpoint.cursor << " of ["
+                      << checkpoint.range.begin << ", " << checkpoint.range.end
+                      << ")" << std::endl;
+        }
+    }
+    auto merged = fsr::merge_checkpoints(loaded);
+    for (const auto& [hash, path] : merged.hits)
+    {
+        print_hit(hash, path);
+    }
+    std::cerr << merged.hits.size() << " resolved, " << merged.pending.size()
+              << " pending" << std::endl;
+    if (!output.empty())
+    {
+        fsr::save_checkpoint(merged, output);
+    }
+}
+} // namespace resolver
+void add_resolve_sub_command(CLI::App& app, std::vector<std::string>& paths,
+                             resolver::resolve_args_t& args)
+{
+    auto resolve = app.add_subcommand(
+        "resolve", "Resolve the paths of hashfs archives from the directories, "
+                   "names and extensions they already know");
+    resolve->add_option("archives", paths, "Archives, or hash lists with --hashes")
+        ->required()
+        ->type_name("PATHS");
+    resolve->add_option("-w,--words", args.words,
+                        "Files of known paths, one per line, directories end with '/'")
+        ->type_name("PATHS");
+    resolve->add_flag("--hashes", args.hash_lists,
+                      "Read hexadecimal hashes, one per line, instead of "
+                      "archives and search the words for them");
+    resolve->add_option("-s,--salt", args.salt,
+                        "Salt the hashes of --hashes were made with");
+    resolve->add_option("-j,--jobs", args.threads, "Threads to use, 0 for all cores");
+    resolve->add_option("-r,--rules", args.rules,
+                        "Mutate the known paths with the rules in this file, or "
+                        "the built-in ones for \"default\", instead of combining them")
+        ->type_name("PATH");
+    resolve->add_option("-c,--checkpoint", args.checkpoint,
+                        "Save progress and hits to this file every minute")
+        ->type_name("PATH");
+    resolve->add_flag("--resume", args.resume,
+                      "Continue from the checkpoint file if there is one");
+    resolve->add_option("--shard", args.shard,
+                        "Only search shard INDEX of COUNT, to split a search "
+                        "between processes")
+        ->type_name("INDEX COUNT");
+    resolve->callback([&]() { resolver::resolve(paths, args); });
+}
+void add_resolve_merge_sub_command(CLI::App& app,
+                                   std::vector<std::string>& paths,
+                                   std::string& output)
+{
+    auto merge = app.add_subcommand(
+        "resolve-merge", "Combine the hits of the checkpoints of resolve shards");
+    merge->add_option("checkpoints", paths, "Checkpoint files")
+        ->required()
+        ->type_name("PATHS");
+    merge->add_option("-o,--output", output, "Write the merged checkpoint here")
+        ->type_name("PATH");
+    merge->callback([&]() { resolver::merge(paths, output); });
+}
+} // namespace ssharp::cli
@@ -30,15 +30,52 @@ void hash(const std::vector<std::string>& strs, uint16_t salt, bool verbose);
 } // namespace hash
 namespace compressor
 {
-void compress(const std::vector<std::string>& paths, const std::string& type);
-void decompress(const std::vector<std::string>& paths, const std::string& type);
+void compress(const std::vector<std::string>& paths, const std::string& type,
+              const std::string& dictionaries, size_t jobs,
+              const std::string& profile);
+void decompress(const std::vector<std::string>& paths, const std::string& type,
+                const std::string& dictionaries);
+void train(const std::vector<std::string>& paths, const std::string& output,
+           size_t capacity);
+void transcode(const std::vector<std::string>& paths, const std::string& from,
+               const std::string& to);
+void tune(const std::vector<std::string>& paths, const std::string& type,
+          double budget);
 } // namespace compress
+namespace resolver
+{
+struct resolve_args_t
+{
+    std::vector<std::string> words;
+    // inputs are hash lists searched with words instead of archives
+    bool hash_lists = false;
+    uint16_t salt = 0;
+    size_t threads = 0;
+    std::string rules;
+    std::string checkpoint;
+    bool resume = false;
+    std::pair<size_t, size_t> shard{0, 1};
+};
+void resolve(const std::vector<std::string>& inputs, const resolve_args_t& args);
+void merge(const std::vector<std::string>& checkpoints, const std::string& output);
+} // namespace resolver
 void add_parser_sub_command(CLI::App& app, std::vector<std::string>& paths,
                             std::string& type);
 void add_hash_sub_command(CLI::App& app, std::vector<std::string>& strs,
-                            uint8_t& salt, bool& verbose);
+                            uint16_t& salt, bool& verbose);
 void add_compress_sub_command(CLI::App& app, std::vector<std::string>& paths,
-                            std::string& type);
+                            std::string& type, std::string& dictionaries,
+                            size_t& jobs, std::string& profile);
 void add_decompress_sub_command(CLI::App& app, std::vector<std::string>& paths,
-                            std::string& type);
+                            std::string& type, std::string& dictionaries);
+void add_train_dict_sub_command(CLI::App& app, std::vector<std::string>& paths,
+                            std::string& output, size_t& capacity);
+void add_transcode_sub_command(CLI::App& app, std::vector<std::string>& paths,
+                            std::string& from, std::string& to);
+void add_tune_sub_command(CLI::App& app, std::vector<std::string>& paths,
+                            std::string& type, double& budget);
+void add_resolve_sub_command(CLI::App& app, std::vector<std::string>& paths,
+                            resolver::resolve_args_t& args);
+void add_resolve_merge_sub_command(CLI::App& app, std::vector<std::string>& paths,
+                            std::string& output);
 } // namespace ssharp::cli
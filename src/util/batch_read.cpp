@@ -0,0 +1,185 @@
+// Copyright (C) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "batch_read.hpp"
+
+#include <algorithm>
+
+#ifdef SSHARP_HAVE_LIBURING
+#include <liburing.h>
+
+#include <cerrno>
+#include <deque>
+#endif
+
+namespace ssharp::util
+{
+
+namespace
+{
+
+// a request translated to absolute file offsets, advanced on short reads
+struct pending_read_t
+{
+    uint8_t* out;
+    size_t size;
+    size_t offset;
+};
+
+void read_with_pool(const file_t& file, std::vector<pending_read_t>& reads,
+                    thread_pool_t& pool)
+{
+    // a worker waiting on its own pool can deadlock it
+    if (pool.is_worker())
+    {
+        for (const auto& read : reads)
+        {
+            file.read_at(read.out, read.size, read.offset);
+        }
+        return;
+    }
+    pool.parallel_for(reads.size(), [&](size_t i) {
+        file.read_at(reads[i].out, reads[i].size, reads[i].offset);
+    });
+}
+
+#ifdef SSHARP_HAVE_LIBURING
+// returns false if the kernel refuses to set up a ring
+bool read_with_uring(const file_t& file, std::vector<pending_read_t>& reads,
+                     size_t queue_depth)
+{
+    io_uring ring;
+    if (io_uring_queue_init(static_cast<unsigned>(queue_depth), &ring, 0) < 0)
+    {
+        return false;
+    }
+    // a single sqe reads at most 1 GiB, longer reads continue as short reads
+    constexpr size_t max_read = size_t{1} << 30;
+    std::deque<size_t> queued;
+    for (size_t i = 0; i < reads.size(); i++)
+    {
+        queued.push_back(i);
+    }
+    size_t in_flight = 0;
+    bool failed = false;
+    while (in_flight > 0 || (!failed && !queued.empty()))
+    {
+        while (!failed && !queued.empty() && in_flight < queue_depth)
+        {
+            auto sqe = io_uring_get_sqe(&ring);
+            if (sqe == nullptr)
+            {
+                break;
+            }
+            auto index = queued.front();
+            queued.pop_front();
+            auto& read = reads[index];
+            io_uring_prep_read(sqe, file.native_handle(), read.out,
+                               static_cast<unsigned>(
+                                   std::min(read.size, max_read)),
+                               read.offset);
+            io_uring_sqe_set_data64(sqe, index);
+            in_flight++;
+        }
+        io_uring_submit_and_wait(&ring, 1);
+        io_uring_cqe* cqe;
+        while (io_uring_peek_cqe(&ring, &cqe) == 0)
+        {
+            auto index = static_cast<size_t>(io_uring_cqe_get_data64(cqe));
+            auto result = cqe->res;
+            io_uring_cqe_seen(&ring, cqe);
+            in_flight--;
+            auto& read = reads[index];
+            if (result == -EINTR || result == -EAGAIN)
+            {
+                queued.push_back(index);
+                continue;
+            }
+            if (result <= 0)
+            {
+                // keep reaping, in-flight reads still target caller buffers
+                failed = true;
+                continue;
+            }
+            read.out += result;
+            read.offset += result;
+            read.size -= result;
+            if (read.size > 0)
+            {
+                queued.push_back(index);
+            }
+        }
+    }
+    io_uring_queue_exit(&ring);
+    if (failed)
+    {
+        throw std::ios::failure("failed to read file: " +
+                                file.path().string());
+    }
+    return true;
+}
+#endif
+
+} // namespace
+
+void read_batch(const span_t& span, std::span<const read_request_t> requests,
+                [[maybe_unused]] size_t queue_depth, thread_pool_t& pool)
+{
+    for (const auto& request : requests)
+    {
+        auto [pos, size] = request.attr;
+        if (static_cast<size_t>(pos) + size > span.size())
+        {
+            throw ssexcept::span_error("Out of range error");
+        }
+        if (request.out.size() < size)
+        {
+            throw ssexcept::span_error("output buffer too small");
+        }
+    }
+    if (span.view())
+    {
+        for (const auto& request : requests)
+        {
+            auto view = *span.view(request.attr);
+            std::copy(view.begin(), view.end(), request.out.begin());
+        }
+        return;
+    }
+    auto file = span.file();
+    if (!file)
+    {
+        throw ssexcept::span_error("Invalid span source");
+    }
+    std::vector<pending_read_t> reads;
+    reads.reserve(requests.size());
+    for (const auto& request : requests)
+    {
+        if (request.attr.second == 0)
+        {
+            continue;
+        }
+        reads.push_back({request.out.data(), request.attr.second,
+                         span.offset() +
+                             static_cast<size_t>(request.attr.first)});
+    }
+#ifdef SSHARP_HAVE_LIBURING
+    if (read_with_uring(*file, reads, std::max<size_t>(queue_depth, 1)))
+    {
+        return;
+    }
+#endif
+    read_with_pool(*file, reads, pool);
+}
+
+} // namespace ssharp::util
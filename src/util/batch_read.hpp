@@ -0,0 +1,49 @@
+// Copyright (C) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "util/span.hpp"
+#include "util/thread_pool.hpp"
+#include "util/types.hpp"
+
+namespace ssharp::util
+{
+
+using namespace ssharp::types;
+
+struct read_request_t
+{
+    span_attr_t attr;       // range to read, relative to the span
+    std::span<uint8_t> out; // receives attr.second bytes
+};
+
+/**
+ * @brief Read many ranges of one span at once
+ *
+ * Path-backed spans submit the reads through io_uring when ssharp is built
+ * with liburing and the kernel supports it, and spread positional reads
+ * over a thread pool otherwise. Memory-resident spans are copied.
+ * @param span The span to read from
+ * @param requests The ranges to read and where to put them
+ * @param queue_depth The maximum number of reads in flight
+ * @param pool The pool positional reads are spread over, they run on the
+ *             calling thread when it is a worker of pool
+ * @throws span_error if a range is out of bounds or its buffer is too small
+ * @throws std::ios::failure on I/O errors
+ */
+void read_batch(const span_t& span, std::span<const read_request_t> requests,
+                size_t queue_depth = 64,
+                thread_pool_t& pool = default_thread_pool());
+
+} // namespace ssharp::util
@@ -0,0 +1,66 @@
+// Copyright (C) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "chunk_reader.hpp"
+
+#include <algorithm>
+
+namespace ssharp::util
+{
+
+chunk_reader_t::chunk_reader_t(const span_t& span, size_t chunk_size,
+                               access_advice_t advice, bool drop_behind) :
+    span(span), chunk_size(std::max<size_t>(chunk_size, 1)), advice(advice),
+    drop_behind(drop_behind), file(span.file())
+{
+    if (advice != access_advice_t::normal)
+    {
+        span.advise(advice);
+    }
+}
+
+buff_view_t chunk_reader_t::next()
+{
+    if (drop_behind && position > 0)
+    {
+        auto previous = (position - 1) / chunk_size * chunk_size;
+        span.advise(access_advice_t::dont_need,
+                    span_attr_t{previous, position - previous});
+    }
+    if (done())
+    {
+        return {};
+    }
+    auto size = std::min(chunk_size, span.size() - position);
+    span_attr_t part{position, size};
+    position += size;
+    if (advice == access_advice_t::sequential && !done())
+    {
+        span.advise(access_advice_t::will_need,
+                    span_attr_t{position,
+                                std::min(chunk_size, span.size() - position)});
+    }
+    if (auto view = span.view(part))
+    {
+        return *view;
+    }
+    if (!file)
+    {
+        throw ssexcept::span_error("Invalid span source");
+    }
+    buffer.resize(size);
+    file->read_at(buffer.data(), size, span.offset() + position - size);
+    return buffer;
+}
+
+} // namespace ssharp::util
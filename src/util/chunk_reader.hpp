@@ -0,0 +1,68 @@
+// Copyright (C) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "util/span.hpp"
+#include "util/types.hpp"
+
+namespace ssharp::util
+{
+
+using namespace ssharp::types;
+
+/**
+ * @brief Walks a span front to back in fixed-size chunks
+ *
+ * Memory-resident spans yield views into the source. Path-backed spans are
+ * read into one reused buffer, so at most chunk_size bytes are held at once.
+ * With access_advice_t::sequential the chunk after the current one is
+ * prefetched, with drop_behind consumed chunks are dropped from the page
+ * cache so a large scan does not evict everything else.
+ */
+class chunk_reader_t
+{
+  public:
+    explicit chunk_reader_t(const span_t& span,
+                            size_t chunk_size = 1024 * 1024,
+                            access_advice_t advice = access_advice_t::normal,
+                            bool drop_behind = false);
+
+    /**
+     * @brief Get the next chunk
+     * @return The next chunk, empty once the span is exhausted
+     * @note The chunk is valid until the next call
+     */
+    buff_view_t next();
+
+    bool done() const
+    {
+        return position >= span.size();
+    }
+
+    size_t tell() const
+    {
+        return position;
+    }
+
+  private:
+    span_t span;
+    size_t chunk_size;
+    access_advice_t advice;
+    bool drop_behind;
+    size_t position = 0;
+    file_ptr_t file;
+    buff_t buffer;
+};
+
+} // namespace ssharp::util
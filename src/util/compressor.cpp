@@ -12,9 +12,18 @@
 // limitations under the License.
 
 #include "compressor.hpp"
+#include "util/chunk_reader.hpp"
+#include <algorithm>
+#include <array>
 #include <bitset>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <thread>
 
 #include "zlib-ng.h"
+#define ZSTD_STATIC_LINKING_ONLY // ZSTD_decompressBound
+#include "zstd.h"
 #include "zbuild.h"
 #include "zutil.h"
 #ifdef S390_DFLTCC_DEFLATE
@@ -117,25 +126,107 @@ size_t inline compress_bound(size_t source_len, compress_type_t type)
 #endif
 }
 
-buff_t compress(const buff_t& data, compress_type_t type)
+namespace
 {
-    buff_t compressed;
-    PREFIX3(stream) stream;
+
+struct deflate_params_t
+{
+    int level = Z_DEFAULT_COMPRESSION;
+    int strategy = Z_DEFAULT_STRATEGY;
+    int mem_level = DEF_MEM_LEVEL;
+
+    bool operator==(const deflate_params_t&) const = default;
+};
+
+// moves a freshly reset deflate stream to new settings, only a mem_level
+// change needs new allocations
+void configure_deflate(PREFIX3(stream)& stream, int32_t window_bits,
+                       deflate_params_t& current,
+                       const compress_options_t& options)
+{
+    deflate_params_t wanted{options.level.value_or(Z_DEFAULT_COMPRESSION),
+                            static_cast<int>(options.strategy),
+                            options.mem_level};
+    if (wanted == current)
+        return;
     int err;
-    const unsigned int max = (unsigned int)-1;
-    z_size_t left;
+    if (wanted.mem_level != current.mem_level)
+    {
+        PREFIX(deflateEnd)(&stream);
+        err = PREFIX(deflateInit2)(&stream, wanted.level, Z_DEFLATED,
+                                   window_bits, wanted.mem_level,
+                                   wanted.strategy);
+    }
+    else
+    {
+        err = PREFIX(deflateParams)(&stream, wanted.level, wanted.strategy);
+    }
+    if (err != Z_OK)
+        throw ssexcept::exception("Invalid compression options");
+    current = wanted;
+}
 
-    left = compress_bound(data.size(), type);
-    compressed.resize(left);
+} // namespace
+
+compress_options_t profile_options(compress_profile_t profile,
+                                   compress_type_t type)
+{
+    switch (profile)
+    {
+        case compress_profile_t::fast:
+            return {1};
+        case compress_profile_t::max_ratio:
+            return {type == compress_type_t::zstd ? 19 : 9,
+                    deflate_strategy_t::normal, 9};
+        case compress_profile_t::normal:
+        default:
+            break;
+    }
+    return {};
+}
 
+struct deflate_context_t::state_t
+{
+    PREFIX3(stream) stream;
+    compress_type_t type;
+    deflate_params_t params;
+};
+
+deflate_context_t::deflate_context_t(compress_type_t type) :
+    state(std::make_unique<state_t>())
+{
+    auto& stream = state->stream;
+    state->type = type;
     stream.zalloc = NULL;
     stream.zfree = NULL;
     stream.opaque = NULL;
-
-    err = PREFIX(deflateInit2)(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
-                               wbits(type), DEF_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+    int err = PREFIX(deflateInit2)(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                                   wbits(type), DEF_MEM_LEVEL,
+                                   Z_DEFAULT_STRATEGY);
     if (err != Z_OK)
         throw ssexcept::exception("Failed to initialize compression stream");
+}
+
+deflate_context_t::~deflate_context_t()
+{
+    PREFIX(deflateEnd)(&state->stream);
+}
+
+buff_t deflate_context_t::compress(buff_view_t data,
+                                   const compress_options_t& options)
+{
+    auto& stream = state->stream;
+    buff_t compressed;
+    int err;
+    const unsigned int max = (unsigned int)-1;
+    z_size_t left;
+
+    // keeps the allocated window and hash tables from the previous call
+    PREFIX(deflateReset)(&stream);
+    configure_deflate(stream, wbits(state->type), state->params, options);
+
+    left = compress_bound(data.size(), state->type);
+    compressed.resize(left);
 
     stream.next_out = compressed.data();
     stream.avail_out = 0;
@@ -153,9 +244,9 @@ buff_t compress(const buff_t& data, compress_type_t type)
         }
         if (stream.avail_in == 0)
         {
-            stream.avail_in = data.size() > (unsigned long)max
+            stream.avail_in = source_remaining > (unsigned long)max
                                   ? max
-                                  : (unsigned int)data.size();
+                                  : (unsigned int)source_remaining;
             source_remaining -= stream.avail_in;
         }
         err =
@@ -164,140 +255,1023 @@ buff_t compress(const buff_t& data, compress_type_t type)
 
     if (err != Z_STREAM_END)
     {
-        PREFIX(deflateEnd)(&stream);
         return buff_t();
     }
 
     compressed.resize(stream.total_out);
-    PREFIX(deflateEnd)(&stream);
     return compressed;
 }
 
-buff_t decompress(const buff_t& data, compress_type_t type,
-                  std::optional<size_t> fixed_output_size,
-                  std::optional<size_t> peek_size)
+struct inflate_context_t::state_t
 {
-    buff_t decompressed;
-
     PREFIX3(stream) stream;
+    int32_t window_bits;
+};
+
+inflate_context_t::inflate_context_t(compress_type_t type) :
+    state(std::make_unique<state_t>())
+{
+    auto& stream = state->stream;
+    state->window_bits = wbits(type);
+    stream.next_in = NULL;
+    stream.avail_in = 0;
+    stream.zalloc = NULL;
+    stream.zfree = NULL;
+    stream.opaque = NULL;
+    int err = PREFIX(inflateInit2)(&stream, state->window_bits);
+    if (err != Z_OK)
+        throw ssexcept::exception("Failed to initialize decompression stream");
+}
+
+inflate_context_t::~inflate_context_t()
+{
+    PREFIX(inflateEnd)(&state->stream);
+}
+
+namespace
+{
+
+// sizes read from a stream are not checked until the end, only trust them
+// as far as deflate can expand, about 1032:1, any more grows as it goes
+constexpr size_t max_trusted_ratio = 1032;
+
+// inflates all of data into out, grow(out) is asked for a larger buffer
+// holding what was produced so far whenever out fills up, and returns an
+// empty span when it cannot grow
+// on_output sees every newly produced piece of at most step bytes while it
+// is still in cache
+template <typename grow_t, typename output_t>
+size_t inflate_all(PREFIX3(stream)& stream, buff_view_t data,
+                   std::span<uint8_t> out, std::optional<size_t> peek_size,
+                   grow_t&& grow, output_t&& on_output,
+                   size_t step = (unsigned int)-1)
+{
     int err;
     const unsigned int max = (unsigned int)-1;
-    z_size_t left;
-
+    // inflate rejects a null next_out even when no output is expected
+    uint8_t placeholder;
     auto source_remaining = data.size();
-    auto reserving = data.size() * 2;
+    stream.next_in = (z_const unsigned char*)data.data();
+    stream.avail_in = 0;
+    stream.avail_out = 0;
+    size_t produced = 0;
+    bool can_grow = true;
 
     do
     {
-        if (fixed_output_size)
+        if (stream.avail_out == 0)
+        {
+            // grow and carry on with the same stream, nothing is inflated
+            // twice
+            if (produced == out.size() && can_grow)
+            {
+                auto grown = grow(out);
+                can_grow = !grown.empty();
+                if (can_grow)
+                    out = grown;
+            }
+            auto left = std::min(out.size() - produced, step);
+            stream.next_out = out.empty() ? &placeholder : out.data() + produced;
+            stream.avail_out =
+                left > (unsigned long)max ? max : (unsigned int)left;
+        }
+        if (stream.avail_in == 0)
         {
-            left = fixed_output_size.value();
+            stream.avail_in = source_remaining > (unsigned long)max
+                                  ? max
+                                  : (unsigned int)source_remaining;
+            source_remaining -= stream.avail_in;
         }
-        else
+        err = PREFIX(inflate)(&stream, Z_NO_FLUSH);
+        if (!out.empty())
         {
-            left = reserving;
+            size_t now = stream.next_out - out.data();
+            if (now != produced)
+                on_output(out.subspan(produced, now - produced));
+            produced = now;
         }
-        decompressed.resize(left);
+        if (err == Z_OK && peek_size && produced >= peek_size.value())
+        {
+            err = Z_STREAM_END;
+        }
+        // out of room is only fatal once the output cannot grow
+        if (err == Z_BUF_ERROR && stream.avail_out == 0 && can_grow)
+        {
+            err = Z_OK;
+        }
+    } while (err == Z_OK);
 
-        stream.next_in = (z_const unsigned char*)data.data();
-        stream.avail_in = 0;
-        stream.zalloc = NULL;
-        stream.zfree = NULL;
-        stream.opaque = NULL;
+    if (err != Z_STREAM_END)
+    {
+        throw ssexcept::exception("Failed to decompress data");
+    }
+    return produced;
+}
 
-        err = PREFIX(inflateInit2)(&stream, wbits(type));
-        if (err != Z_OK)
-            throw ssexcept::exception(
-                "Failed to initialize decompression stream");
+} // namespace
+
+buff_t inflate_context_t::decompress(buff_view_t data,
+                                     std::optional<size_t> fixed_output_size,
+                                     std::optional<size_t> peek_size)
+{
+    size_t reserving = std::max<size_t>(data.size() * 2, 64);
+    // a single-member gzip stream ends with its size modulo 2^32
+    if (state->window_bits == wbits(compress_type_t::gzip) &&
+        data.size() >= GZIP_WRAPLEN)
+    {
+        uint32_t isize;
+        std::memcpy(&isize, data.data() + data.size() - 4, sizeof(isize));
+        reserving = std::max<size_t>(
+            reserving,
+            std::min<size_t>(isize, data.size() * max_trusted_ratio));
+    }
+    buff_t decompressed(fixed_output_size.value_or(reserving));
+
+    // keeps the allocated window from the previous call
+    PREFIX(inflateReset2)(&state->stream, state->window_bits);
+    auto produced = inflate_all(
+        state->stream, data, decompressed, peek_size,
+        [&](std::span<uint8_t>) -> std::span<uint8_t> {
+            if (fixed_output_size)
+                return {};
+            decompressed.resize(decompressed.size() * 2);
+            return decompressed;
+        },
+        [](std::span<uint8_t>) {});
+    decompressed.resize(produced);
+    return decompressed;
+}
+
+size_t inflate_context_t::decompress(buff_view_t data,
+                                     std::span<uint8_t> output)
+{
+    PREFIX(inflateReset2)(&state->stream, state->window_bits);
+    return inflate_all(state->stream, data, output, std::nullopt,
+                       [](std::span<uint8_t>) { return std::span<uint8_t>{}; },
+                       [](std::span<uint8_t>) {});
+}
+
+size_t inflate_context_t::decompress(buff_view_t data,
+                                     std::span<uint8_t> output,
+                                     uint32_t& crc)
+{
+    // about an L2 worth, the crc reads what inflate just wrote from cache,
+    // much smaller steps cost more in inflate calls than they save
+    constexpr size_t step = 1024 * 1024;
+    PREFIX(inflateReset2)(&state->stream, state->window_bits);
+    crc = PREFIX(crc32)(0, nullptr, 0);
+    return inflate_all(
+        state->stream, data, output, std::nullopt,
+        [](std::span<uint8_t>) { return std::span<uint8_t>{}; },
+        [&](std::span<uint8_t> piece) {
+            crc = PREFIX(crc32)(crc, piece.data(), piece.size());
+        },
+        step);
+}
+
+struct zstd_context_t::state_t
+{
+    ZSTD_CCtx* cctx = nullptr;
+    ZSTD_DCtx* dctx = nullptr;
+};
+
+zstd_context_t::zstd_context_t() : state(std::make_unique<state_t>())
+{
+    state->cctx = ZSTD_createCCtx();
+    state->dctx = ZSTD_createDCtx();
+    if (state->cctx == nullptr || state->dctx == nullptr)
+    {
+        ZSTD_freeCCtx(state->cctx);
+        ZSTD_freeDCtx(state->dctx);
+        throw ssexcept::exception("Failed to initialize zstd context");
+    }
+}
+
+zstd_context_t::~zstd_context_t()
+{
+    ZSTD_freeCCtx(state->cctx);
+    ZSTD_freeDCtx(state->dctx);
+}
+
+namespace
+{
+
+// picks the dictionary named by the frame header, or none
+void ref_frame_dictionary(ZSTD_DCtx* dctx, buff_view_t data)
+{
+    ZSTD_DCtx_reset(dctx, ZSTD_reset_session_and_parameters);
+    auto id = ZSTD_getDictID_fromFrame(data.data(), data.size());
+    if (id == 0)
+    {
+        return;
+    }
+    auto dictionary = find_zstd_dictionary(id);
+    if (!dictionary)
+    {
+        throw ssexcept::exception("Failed to decompress data: missing "
+                                  "dictionary " + std::to_string(id));
+    }
+    ZSTD_DCtx_refDDict(dctx, dictionary->ddict());
+}
 
-        stream.next_out = decompressed.data();
-        stream.avail_out = 0;
+} // namespace
 
-        do
+buff_t zstd_context_t::compress(buff_view_t data, int level,
+                                unsigned int workers,
+                                const zstd_dictionary_t* dictionary)
+{
+    auto cctx = state->cctx;
+    if (workers == 0 && data.size() >= mt_threshold)
+    {
+        workers = std::thread::hardware_concurrency();
+    }
+    ZSTD_CCtx_reset(cctx, ZSTD_reset_session_and_parameters);
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level);
+    // fails on builds without ZSTD_MULTITHREAD, which then stay single
+    // threaded
+    if (workers > 1)
+    {
+        ZSTD_CCtx_setParameter(cctx, ZSTD_c_nbWorkers,
+                               static_cast<int>(workers));
+    }
+    if (dictionary != nullptr)
+    {
+        ZSTD_CCtx_refCDict(cctx, dictionary->cdict(level));
+    }
+    buff_t compressed(ZSTD_compressBound(data.size()));
+    auto size = ZSTD_compress2(cctx, compressed.data(), compressed.size(),
+                               data.data(), data.size());
+    if (ZSTD_isError(size))
+    {
+        throw ssexcept::exception(std::string{"Failed to compress data: "} +
+                                  ZSTD_getErrorName(size));
+    }
+    compressed.resize(size);
+    return compressed;
+}
+
+buff_t zstd_context_t::decompress(buff_view_t data,
+                                  std::optional<size_t> fixed_output_size,
+                                  std::optional<size_t> peek_size)
+{
+    auto dctx = state->dctx;
+    ref_frame_dictionary(dctx, data);
+    auto content_size = ZSTD_getFrameContentSize(data.data(), data.size());
+    if (content_size == ZSTD_CONTENTSIZE_ERROR)
+    {
+        throw ssexcept::exception("Failed to decompress data");
+    }
+    // the header of a single frame gives the size, decode in one shot as
+    // long as it is within what the blocks can produce and a sane ratio
+    auto trusted_size = std::min<unsigned long long>(
+        ZSTD_decompressBound(data.data(), data.size()),
+        data.size() * max_trusted_ratio);
+    auto single_frame =
+        ZSTD_findFrameCompressedSize(data.data(), data.size()) == data.size();
+    if (!peek_size && single_frame && content_size <= trusted_size)
+    {
+        if (fixed_output_size && *fixed_output_size < content_size)
         {
-            if (stream.avail_out == 0)
-            {
-                stream.avail_out =
-                    left > (unsigned long)max ? max : (unsigned int)left;
-                left -= stream.avail_out;
-            }
-            if (stream.avail_in == 0)
+            throw ssexcept::exception("Failed to decompress data");
+        }
+        buff_t decompressed(content_size);
+        decompressed.resize(decompress(data, decompressed));
+        return decompressed;
+    }
+
+    size_t reserving = std::max<size_t>(data.size() * 2, 64);
+    if (content_size != ZSTD_CONTENTSIZE_UNKNOWN)
+    {
+        reserving = std::max<size_t>(
+            reserving,
+            std::min<unsigned long long>(content_size, trusted_size));
+    }
+    buff_t decompressed(fixed_output_size.value_or(reserving));
+    ZSTD_inBuffer input{data.data(), data.size(), 0};
+    ZSTD_outBuffer output{decompressed.data(), decompressed.size(), 0};
+    while (true)
+    {
+        auto hint = ZSTD_decompressStream(dctx, &output, &input);
+        if (ZSTD_isError(hint))
+        {
+            throw ssexcept::exception(
+                std::string{"Failed to decompress data: "} +
+                ZSTD_getErrorName(hint));
+        }
+        // a frame ended, the next one starts on the following call
+        if ((hint == 0 && input.pos == input.size) ||
+            (peek_size && output.pos >= *peek_size))
+        {
+            break;
+        }
+        if (output.pos == output.size)
+        {
+            if (fixed_output_size)
             {
-                stream.avail_in = data.size() > (unsigned long)max
-                                      ? max
-                                      : (unsigned int)data.size();
-                source_remaining -= stream.avail_in;
+                throw ssexcept::exception("Failed to decompress data");
             }
-            err = PREFIX(inflate)(&stream,
-                                  source_remaining ? Z_NO_FLUSH : Z_FINISH);
-            if (err == Z_OK && peek_size &&
-                stream.total_out >= peek_size.value())
+            decompressed.resize(decompressed.size() * 2);
+            output.dst = decompressed.data();
+            output.size = decompressed.size();
+        }
+        else if (input.pos == input.size)
+        {
+            throw ssexcept::exception("Failed to decompress data: truncated");
+        }
+    }
+    decompressed.resize(output.pos);
+    return decompressed;
+}
+
+size_t zstd_context_t::decompress(buff_view_t data, std::span<uint8_t> output)
+{
+    ref_frame_dictionary(state->dctx, data);
+    auto size = ZSTD_decompressDCtx(state->dctx, output.data(), output.size(),
+                                    data.data(), data.size());
+    if (ZSTD_isError(size))
+    {
+        throw ssexcept::exception(std::string{"Failed to decompress data: "} +
+                                  ZSTD_getErrorName(size));
+    }
+    return size;
+}
+
+namespace
+{
+
+// one slot per zlib based compress_type_t
+size_t context_slot(compress_type_t type)
+{
+    switch (type)
+    {
+        case compress_type_t::zlib:
+            return 0;
+        case compress_type_t::raw:
+            return 1;
+        case compress_type_t::gzip:
+            return 2;
+        default:
+            break;
+    }
+    throw ssexcept::exception("Invalid compression type");
+}
+
+} // namespace
+
+deflate_context_t& thread_deflate_context(compress_type_t type)
+{
+    thread_local std::array<std::unique_ptr<deflate_context_t>, 3> contexts;
+    auto& context = contexts[context_slot(type)];
+    if (!context)
+    {
+        context = std::make_unique<deflate_context_t>(type);
+    }
+    return *context;
+}
+
+inflate_context_t& thread_inflate_context(compress_type_t type)
+{
+    thread_local std::array<std::unique_ptr<inflate_context_t>, 3> contexts;
+    auto& context = contexts[context_slot(type)];
+    if (!context)
+    {
+        context = std::make_unique<inflate_context_t>(type);
+    }
+    return *context;
+}
+
+zstd_context_t& thread_zstd_context()
+{
+    thread_local zstd_context_t context;
+    return context;
+}
+
+buff_t compress(const buff_t& data, compress_type_t type)
+{
+    if (type == compress_type_t::zstd)
+        return thread_zstd_context().compress(data);
+    return thread_deflate_context(type).compress(data);
+}
+
+buff_t compress(const buff_t& data, compress_type_t type, file_type_t file_type,
+                const compress_options_t& options)
+{
+    if (type == compress_type_t::zstd)
+    {
+        auto dictionary = find_zstd_dictionary(file_type);
+        return thread_zstd_context().compress(
+            data, options.level.value_or(zstd_context_t::default_level), 0,
+            dictionary.get());
+    }
+    return thread_deflate_context(type).compress(data, options);
+}
+
+buff_t compress(const buff_t& data, compress_type_t type,
+                const compress_options_t& options)
+{
+    if (type == compress_type_t::zstd)
+        return thread_zstd_context().compress(
+            data, options.level.value_or(zstd_context_t::default_level));
+    return thread_deflate_context(type).compress(data, options);
+}
+
+buff_t decompress(const buff_t& data, compress_type_t type,
+                  std::optional<size_t> fixed_output_size,
+                  std::optional<size_t> peek_size)
+{
+    if (type == compress_type_t::zstd)
+        return thread_zstd_context().decompress(data, fixed_output_size,
+                                                peek_size);
+    return thread_inflate_context(type).decompress(data, fixed_output_size,
+                                                   peek_size);
+}
+
+namespace
+{
+
+struct block_stream_t
+{
+    PREFIX3(stream) stream{};
+    deflate_params_t params;
+
+    block_stream_t()
+    {
+        int err = PREFIX(deflateInit2)(&stream, Z_DEFAULT_COMPRESSION,
+                                       Z_DEFLATED, -DEF_WBITS, DEF_MEM_LEVEL,
+                                       Z_DEFAULT_STRATEGY);
+        if (err != Z_OK)
+            throw ssexcept::exception(
+                "Failed to initialize compression stream");
+    }
+    ~block_stream_t()
+    {
+        PREFIX(deflateEnd)(&stream);
+    }
+};
+
+// raw deflate of one block, primed with the data preceding it and ended on
+// a byte boundary unless it is the last block
+buff_t deflate_block(buff_view_t block, buff_view_t dictionary, bool last,
+                     const compress_options_t& options)
+{
+    thread_local block_stream_t context;
+    auto& stream = context.stream;
+    PREFIX(deflateReset)(&stream);
+    configure_deflate(stream, -DEF_WBITS, context.params, options);
+    if (!dictionary.empty())
+    {
+        PREFIX(deflateSetDictionary)(&stream, dictionary.data(),
+                                     static_cast<uint32_t>(dictionary.size()));
+    }
+
+    buff_t compressed(compress_bound(block.size(), compress_type_t::raw) + 8);
+    stream.next_in = (z_const unsigned char*)block.data();
+    stream.avail_in = static_cast<uint32_t>(block.size());
+    stream.next_out = compressed.data();
+    stream.avail_out = static_cast<uint32_t>(compressed.size());
+    int flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+    while (true)
+    {
+        int err = PREFIX(deflate)(&stream, flush);
+        if (err == Z_STREAM_ERROR)
+            throw ssexcept::exception("Failed to compress data");
+        if (last ? err == Z_STREAM_END
+                 : stream.avail_in == 0 && stream.avail_out != 0)
+            break;
+        size_t used = stream.total_out;
+        compressed.resize(compressed.size() * 2);
+        stream.next_out = compressed.data() + used;
+        stream.avail_out = static_cast<uint32_t>(compressed.size() - used);
+    }
+    compressed.resize(stream.total_out);
+    return compressed;
+}
+
+// zlib or gzip header in front of a raw deflate stream, nothing for raw
+void append_wrapper_header(buff_t& out, compress_type_t type, int level)
+{
+    if (type == compress_type_t::zlib)
+    {
+        // deflate with a 32 KiB window, FLEVEL only informs recompressors
+        uint8_t flevel = level == Z_DEFAULT_COMPRESSION || level == 6 ? 2
+                         : level < 2                                  ? 0
+                         : level < 6                                  ? 1
+                                                                      : 3;
+        uint8_t cmf = 0x78;
+        uint8_t flg = static_cast<uint8_t>(flevel << 6);
+        flg += 31 - (cmf * 256 + flg) % 31;
+        out.insert(out.end(), {cmf, flg});
+    }
+    else if (type == compress_type_t::gzip)
+    {
+        // no mtime and an unknown OS keep the output reproducible
+        out.insert(out.end(), {0x1F, 0x8B, Z_DEFLATED, 0, 0, 0, 0, 0, 0, 0xFF});
+    }
+}
+
+// adler32 for zlib, crc32 and size for gzip, nothing for raw
+void append_wrapper_trailer(buff_t& out, compress_type_t type, uint32_t check,
+                            size_t size)
+{
+    if (type == compress_type_t::zlib)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8)
+            out.push_back(static_cast<uint8_t>(check >> shift));
+    }
+    else if (type == compress_type_t::gzip)
+    {
+        auto isize = static_cast<uint32_t>(size);
+        for (int shift = 0; shift < 32; shift += 8)
+            out.push_back(static_cast<uint8_t>(check >> shift));
+        for (int shift = 0; shift < 32; shift += 8)
+            out.push_back(static_cast<uint8_t>(isize >> shift));
+    }
+}
+
+} // namespace
+
+buff_t compress_parallel(buff_view_t data, compress_type_t type,
+                         thread_pool_t& pool, size_t block_size,
+                         const compress_options_t& options)
+{
+    if (type == compress_type_t::zstd)
+    {
+        return thread_zstd_context().compress(
+            data, options.level.value_or(zstd_context_t::default_level),
+            static_cast<unsigned int>(pool.size()));
+    }
+    wbits(type);
+    constexpr size_t window_size = size_t{1} << DEF_WBITS;
+    // blocks are handed to deflate in one piece
+    block_size = std::clamp<size_t>(block_size, window_size, size_t{1} << 30);
+    auto count = std::max<size_t>(1, (data.size() + block_size - 1) / block_size);
+
+    std::vector<buff_t> blocks(count);
+    std::vector<uint32_t> checks(count);
+    pool.parallel_for(count, [&](size_t i) {
+        auto offset = i * block_size;
+        auto block =
+            data.subspan(offset, std::min(block_size, data.size() - offset));
+        auto window = std::min(offset, window_size);
+        blocks[i] = deflate_block(block, data.subspan(offset - window, window),
+                                  i + 1 == count, options);
+        if (type == compress_type_t::zlib)
+            checks[i] = PREFIX(adler32)(1, block.data(), block.size());
+        else if (type == compress_type_t::gzip)
+            checks[i] = PREFIX(crc32)(0, block.data(), block.size());
+    });
+
+    uint32_t check = checks[0];
+    for (size_t i = 1; i < count; i++)
+    {
+        auto length = static_cast<z_off64_t>(
+            std::min(block_size, data.size() - i * block_size));
+        if (type == compress_type_t::zlib)
+            check = PREFIX(adler32_combine)(check, checks[i], length);
+        else if (type == compress_type_t::gzip)
+            check = PREFIX(crc32_combine)(check, checks[i], length);
+    }
+
+    buff_t compressed;
+    size_t total = GZIP_WRAPLEN;
+    for (const auto& block : blocks)
+        total += block.size();
+    compressed.reserve(total);
+    append_wrapper_header(compressed, type,
+                          options.level.value_or(Z_DEFAULT_COMPRESSION));
+    for (const auto& block : blocks)
+        compressed.insert(compressed.end(), block.begin(), block.end());
+    append_wrapper_trailer(compressed, type, check, data.size());
+    return compressed;
+}
+
+compress_estimate_t estimate_compression(buff_view_t data)
+{
+    constexpr size_t window_size = 4096;
+    constexpr size_t window_count = 16;
+    constexpr size_t hash_bits = 12;
+    // a match costs a few bits of length and distance instead of its bytes
+    constexpr double match_cost = 0.1;
+
+    std::array<size_t, 256> histogram{};
+    std::array<uint16_t, size_t{1} << hash_bits> table;
+    size_t sampled = 0;
+    size_t matched = 0;
+
+    auto windows = std::min(window_count,
+                            (data.size() + window_size - 1) / window_size);
+    for (size_t w = 0; w < windows; w++)
+    {
+        // spread evenly, the last window ends with the data
+        auto offset = windows == 1 ? 0
+                                   : (data.size() - window_size) * w /
+                                         (windows - 1);
+        auto window = data.subspan(offset,
+                                   std::min(window_size, data.size() - offset));
+        for (auto byte : window)
+            histogram[byte]++;
+        sampled += window.size();
+
+        // greedy LZ pass over 4 byte sequences, like a fast LZ4 level
+        table.fill(UINT16_MAX);
+        size_t i = 0;
+        while (i + 4 <= window.size())
+        {
+            uint32_t sequence;
+            std::memcpy(&sequence, window.data() + i, sizeof(sequence));
+            auto hash = (sequence * 2654435761U) >> (32 - hash_bits);
+            auto candidate = table[hash];
+            table[hash] = static_cast<uint16_t>(i);
+            if (candidate != UINT16_MAX &&
+                std::memcmp(window.data() + candidate, &sequence,
+                            sizeof(sequence)) == 0)
             {
-                err = Z_STREAM_END;
+                size_t length = 4;
+                while (i + length < window.size() &&
+                       window[candidate + length] == window[i + length])
+                    length++;
+                matched += length;
+                i += length;
             }
-            if (err == Z_BUF_ERROR)
+            else
             {
-                if(fixed_output_size)
-                {
-                    PREFIX(inflateEnd)(&stream);
-                    throw ssexcept::exception("Failed to decompress data");
-                }
-                reserving <<= 1;
+                i++;
             }
-        } while (err == Z_OK);
-    } while (err == Z_BUF_ERROR);
+        }
+    }
 
-    if (err != Z_STREAM_END)
+    compress_estimate_t estimate{0, 0, 1};
+    if (sampled == 0)
+        return estimate;
+    for (auto count : histogram)
     {
-        PREFIX(inflateEnd)(&stream);
-        throw ssexcept::exception("Failed to decompress data");
+        if (count == 0)
+            continue;
+        auto p = static_cast<double>(count) / sampled;
+        estimate.entropy -= p * std::log2(p);
     }
+    estimate.match_ratio = static_cast<double>(matched) / sampled;
+    estimate.ratio = (1 - estimate.match_ratio) * estimate.entropy / 8 +
+                     estimate.match_ratio * match_cost;
+    return estimate;
+}
 
-    decompressed.resize(stream.total_out);
-    PREFIX(inflateEnd)(&stream);
-    return decompressed;
+std::optional<buff_t> compress_if_gainful(buff_view_t data,
+                                          compress_type_t type,
+                                          double min_gain,
+                                          compress_stats_t* stats,
+                                          const compress_options_t& options)
+{
+    if (stats)
+        stats->input_bytes += data.size();
+    auto store = [&](std::atomic<size_t> compress_stats_t::*counter) {
+        if (stats)
+        {
+            (stats->*counter)++;
+            stats->output_bytes += data.size();
+        }
+        return std::nullopt;
+    };
+    if (estimate_compression(data).ratio > 1 - min_gain)
+        return store(&compress_stats_t::stored_estimated);
+
+    auto compressed =
+        type == compress_type_t::zstd
+            ? thread_zstd_context().compress(
+                  data, options.level.value_or(zstd_context_t::default_level))
+            : thread_deflate_context(type).compress(data, options);
+    // a compressed stream is never empty, empty is how compress fails
+    if (compressed.empty() || compressed.size() > data.size() * (1 - min_gain))
+        return store(&compress_stats_t::stored_trial);
+    if (stats)
+    {
+        stats->compressed++;
+        stats->output_bytes += compressed.size();
+    }
+    return compressed;
 }
 
-void remove_zlib_attr(buff_t& data)
+uint32_t crc32(buff_view_t data, uint32_t crc)
 {
-    auto constexpr minimum_zlib_size = 6;
-    if (data.size() <= minimum_zlib_size)
-        throw ssexcept::exception("Invalid zlib data");
-    data.erase(data.begin(), data.begin() + 2);
-    data.erase(data.end() - 4, data.end());
+    return PREFIX(crc32)(crc, data.data(), data.size());
 }
 
-void remove_gzip_attr(buff_t& data)
+size_t decompress(buff_view_t data, std::span<uint8_t> output,
+                  compress_type_t type, uint32_t& crc)
+{
+    if (type == compress_type_t::zstd)
+    {
+        auto size = thread_zstd_context().decompress(data, output);
+        crc = crc32(output.first(size));
+        return size;
+    }
+    return thread_inflate_context(type).decompress(data, output, crc);
+}
+
+size_t decompress(buff_view_t data, std::span<uint8_t> output,
+                  compress_type_t type)
+{
+    if (type == compress_type_t::zstd)
+        return thread_zstd_context().decompress(data, output);
+    return thread_inflate_context(type).decompress(data, output);
+}
+
+namespace
+{
+
+size_t gzip_header_size(buff_view_t data)
 {
-    if (data.size() <= sizeof(gzip_header_t) + 8)
+    // ID1 ID2 CM FLG MTIME(4) XFL OS, read by byte as gzip_header_t does
+    // not have this layout
+    constexpr size_t fixed_size = 10;
+    if (data.size() <= fixed_size + 8 || data[0] != 0x1F || data[1] != 0x8B)
         throw ssexcept::exception("Invalid gzip data");
-    gzip_header_t* header = reinterpret_cast<gzip_header_t*>(data.data());
-    auto& flg = header->flg;
-    size_t offset = 10;
+    gzip_flg_t flg(data[3]);
+    size_t offset = fixed_size;
+    auto skip_string = [&]() {
+        while (offset < data.size() && data[offset] != 0)
+            offset++;
+        offset++;
+    };
     if (flg.fextra())
     {
-        offset += data[offset] + data[offset + 1] * 256;
+        // XLEN itself plus the extra field
+        offset += 2 + data[offset] + data[offset + 1] * 256;
     }
     if (flg.fname())
+        skip_string();
+    if (flg.fcomment())
+        skip_string();
+    if (flg.fhcrc())
+        offset += 2;
+    if (data.size() <= offset + 8)
+        throw ssexcept::exception("Invalid gzip data");
+    return offset;
+}
+
+uint32_t load_be32(const uint8_t* p)
+{
+    return uint32_t{p[0]} << 24 | uint32_t{p[1]} << 16 | uint32_t{p[2]} << 8 |
+           p[3];
+}
+
+uint32_t load_le32(const uint8_t* p)
+{
+    return uint32_t{p[3]} << 24 | uint32_t{p[2]} << 16 | uint32_t{p[1]} << 8 |
+           p[0];
+}
+
+} // namespace
+
+buff_view_t deflate_payload(buff_view_t data, compress_type_t type)
+{
+    switch (type)
     {
-        while (data[offset] != 0)
-            offset++;
-        offset++;
+        case compress_type_t::raw:
+            return data;
+        case compress_type_t::zlib:
+        {
+            auto constexpr minimum_zlib_size = 6;
+            if (data.size() <= minimum_zlib_size)
+                throw ssexcept::exception("Invalid zlib data");
+            // preset dictionaries are not supported
+            zlib_header_t header{data[0], data[1]};
+            if ((header.cmf & 0x0F) != Z_DEFLATED || (header.flg & 0x20) ||
+                (header.cmf * 256 + header.flg) % 31 != 0)
+                throw ssexcept::exception("Invalid zlib data");
+            return data.subspan(2, data.size() - 6);
+        }
+        case compress_type_t::gzip:
+        {
+            auto offset = gzip_header_size(data);
+            return data.subspan(offset, data.size() - offset - 8);
+        }
+        default:
+            break;
     }
-    if (flg.fcomment())
+    throw ssexcept::exception("Invalid compression type");
+}
+
+deflate_checksums_t read_checksums(buff_view_t data, compress_type_t type)
+{
+    deflate_checksums_t checksums;
+    if (type == compress_type_t::zlib)
     {
-        while (data[offset] != 0)
-            offset++;
-        offset++;
+        deflate_payload(data, type);
+        checksums.adler32 = load_be32(data.data() + data.size() - 4);
     }
-    if(flg.fhcrc())
+    else if (type == compress_type_t::gzip)
     {
-        offset += 2;
+        deflate_payload(data, type);
+        checksums.crc32 = load_le32(data.data() + data.size() - 8);
+        // ISIZE is the size modulo 2^32, only exact below 4 GiB
+        checksums.size = load_le32(data.data() + data.size() - 4);
     }
-    if(data.size() <= offset + 8)
-        throw ssexcept::exception("Invalid gzip data");
-    data.erase(data.begin(), data.begin() + offset);
-    data.erase(data.end() - 8, data.end());
+    return checksums;
+}
+
+buff_t transcode(buff_view_t data, compress_type_t from, compress_type_t to,
+                 deflate_checksums_t known)
+{
+    auto payload = deflate_payload(data, from);
+    wbits(to);
+    auto trailer = read_checksums(data, from);
+    if (!known.adler32)
+        known.adler32 = trailer.adler32;
+    if (!known.crc32)
+        known.crc32 = trailer.crc32;
+    if (!known.size)
+        known.size = trailer.size;
+
+    bool need_adler = to == compress_type_t::zlib && !known.adler32;
+    bool need_crc =
+        to == compress_type_t::gzip && (!known.crc32 || !known.size);
+    if (need_adler || need_crc)
+    {
+        // one streaming pass, the inflated data only ever sits in a chunk
+        uint32_t adler = PREFIX(adler32)(0, nullptr, 0);
+        uint32_t crc = PREFIX(crc32)(0, nullptr, 0);
+        inflate_stream_t stream(compress_type_t::raw, 64 * 1024);
+        bool finished = stream.write(payload, [&](buff_view_t chunk) {
+            if (need_adler)
+                adler = PREFIX(adler32)(adler, chunk.data(), chunk.size());
+            if (need_crc)
+                crc = PREFIX(crc32)(crc, chunk.data(), chunk.size());
+        });
+        if (!finished)
+            throw ssexcept::exception("Failed to decompress data: truncated");
+        if (need_adler)
+            known.adler32 = adler;
+        if (need_crc)
+            known.crc32 = crc;
+        known.size = stream.total_out();
+    }
+
+    buff_t transcoded;
+    transcoded.reserve(payload.size() + GZIP_WRAPLEN);
+    append_wrapper_header(transcoded, to, Z_DEFAULT_COMPRESSION);
+    transcoded.insert(transcoded.end(), payload.begin(), payload.end());
+    append_wrapper_trailer(
+        transcoded, to,
+        to == compress_type_t::zlib ? known.adler32.value_or(0)
+                                    : known.crc32.value_or(0),
+        known.size.value_or(0));
+    return transcoded;
+}
+
+void remove_zlib_attr(buff_t& data)
+{
+    auto payload = deflate_payload(data, compress_type_t::zlib);
+    // one move instead of erasing the header and trailer separately
+    std::memmove(data.data(), payload.data(), payload.size());
+    data.resize(payload.size());
+}
+
+void remove_gzip_attr(buff_t& data)
+{
+    auto payload = deflate_payload(data, compress_type_t::gzip);
+    std::memmove(data.data(), payload.data(), payload.size());
+    data.resize(payload.size());
+}
+
+struct inflate_stream_t::state_t
+{
+    PREFIX3(stream) stream;
+    buff_t out;
+    bool finished = false;
+};
+
+inflate_stream_t::inflate_stream_t(compress_type_t type, size_t chunk_size) :
+    state(std::make_unique<state_t>())
+{
+    state->out.resize(std::clamp<size_t>(chunk_size, 1, (unsigned int)-1));
+    auto& stream = state->stream;
+    stream.zalloc = NULL;
+    stream.zfree = NULL;
+    stream.opaque = NULL;
+    stream.next_in = NULL;
+    stream.avail_in = 0;
+    if (PREFIX(inflateInit2)(&stream, wbits(type)) != Z_OK)
+        throw ssexcept::exception("Failed to initialize decompression stream");
+}
+
+inflate_stream_t::~inflate_stream_t()
+{
+    PREFIX(inflateEnd)(&state->stream);
+}
+
+bool inflate_stream_t::write(buff_view_t input, const sink_t& sink)
+{
+    auto& stream = state->stream;
+    const unsigned int max = (unsigned int)-1;
+    auto next_in = input.data();
+    auto remaining = input.size();
+    while (!state->finished)
+    {
+        if (stream.avail_in == 0 && remaining > 0)
+        {
+            stream.next_in = (z_const unsigned char*)next_in;
+            stream.avail_in = remaining > max ? max : (unsigned int)remaining;
+            next_in += stream.avail_in;
+            remaining -= stream.avail_in;
+        }
+        stream.next_out = state->out.data();
+        stream.avail_out = (unsigned int)state->out.size();
+        auto err = PREFIX(inflate)(&stream, Z_NO_FLUSH);
+        if (err != Z_OK && err != Z_STREAM_END && err != Z_BUF_ERROR)
+            throw ssexcept::exception("Failed to decompress data");
+        auto produced = state->out.size() - stream.avail_out;
+        if (produced > 0)
+            sink(buff_view_t{state->out.data(), produced});
+        if (err == Z_STREAM_END)
+            state->finished = true;
+        // input used up and inflate had room left, it needs more input
+        else if (stream.avail_in == 0 && remaining == 0 &&
+                 (stream.avail_out != 0 || err == Z_BUF_ERROR))
+            break;
+    }
+    return state->finished;
+}
+
+bool inflate_stream_t::finished() const
+{
+    return state->finished;
+}
+
+size_t inflate_stream_t::total_out() const
+{
+    return state->stream.total_out;
+}
+
+void decompress_stream(const span_t& span, compress_type_t type,
+                       const inflate_stream_t::sink_t& sink,
+                       size_t chunk_size)
+{
+    inflate_stream_t inflater(type, chunk_size);
+    chunk_reader_t reader(span, chunk_size);
+    while (!reader.done())
+    {
+        if (inflater.write(reader.next(), sink))
+            return;
+    }
+    if (!inflater.finished())
+        throw ssexcept::exception("Failed to decompress data: truncated");
+}
+
+std::map<file_type_t, tuned_options_t> tune_compression(
+    const std::map<file_type_t, std::vector<buff_t>>& corpus,
+    compress_type_t type, double budget_ms_per_mib)
+{
+    std::vector<compress_options_t> candidates;
+    if (type == compress_type_t::zstd)
+    {
+        for (int level : {-5, -1, 1, 2, 3, 5, 7, 9, 12, 15, 19})
+            candidates.push_back({level});
+    }
+    else
+    {
+        wbits(type);
+        for (int level = 1; level <= 9; level++)
+            candidates.push_back({level});
+        candidates.push_back({9, deflate_strategy_t::normal, 9});
+        candidates.push_back({6, deflate_strategy_t::filtered});
+        candidates.push_back({9, deflate_strategy_t::filtered, 9});
+        candidates.push_back({6, deflate_strategy_t::rle});
+    }
+
+    std::map<file_type_t, tuned_options_t> tuned;
+    for (const auto& [file_type, samples] : corpus)
+    {
+        size_t input = 0;
+        for (const auto& sample : samples)
+            input += sample.size();
+        if (input == 0)
+            continue;
+        auto mib = static_cast<double>(input) / (1024 * 1024);
+
+        std::optional<tuned_options_t> best;
+        std::optional<tuned_options_t> fastest;
+        for (const auto& candidate : candidates)
+        {
+            size_t output = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (const auto& sample : samples)
+                output += compress(sample, type, candidate).size();
+            std::chrono::duration<double, std::milli> elapsed =
+                std::chrono::steady_clock::now() - start;
+
+            tuned_options_t result{candidate,
+                                   static_cast<double>(output) / input,
+                                   elapsed.count() / mib};
+            if (!fastest || result.ms_per_mib < fastest->ms_per_mib)
+                fastest = result;
+            if (result.ms_per_mib <= budget_ms_per_mib &&
+                (!best || result.ratio < best->ratio))
+                best = result;
+        }
+        tuned[file_type] = best.value_or(*fastest);
+    }
+    return tuned;
 }
 
 } // namespace ssharp::util
@@ -15,18 +15,368 @@
 
 #include "util/types.hpp"
 #include "util/exceptions.hpp"
+#include "util/span.hpp"
+#include "util/thread_pool.hpp"
+#include "util/zstd_dictionary.hpp"
+
+#include <atomic>
+#include <functional>
+#include <memory>
 
 namespace ssharp::util
 {
 using namespace ssharp::types;
 
+/**
+ * @brief deflate strategies, with the values of zlib's Z_* strategies
+ */
+enum class deflate_strategy_t
+{
+    normal = 0,
+    filtered = 1,
+    huffman_only = 2,
+    rle = 3,
+    fixed = 4
+};
+
+/**
+ * @brief Per-call compression settings
+ */
+struct compress_options_t
+{
+    std::optional<int> level; // the type's default level when unset
+    deflate_strategy_t strategy = deflate_strategy_t::normal; // deflate only
+    int mem_level = 8; // deflate only, 1 (least memory) to 9 (fastest)
+
+    bool operator==(const compress_options_t&) const = default;
+};
+
+/**
+ * @brief Ready-made settings, from quick CI packs to release packs
+ */
+enum class compress_profile_t
+{
+    fast,
+    normal,
+    max_ratio
+};
+
+compress_options_t profile_options(compress_profile_t profile,
+                                   compress_type_t type);
+
+/**
+ * @brief A deflate stream kept initialized between calls
+ *
+ * Each call resets the stream instead of tearing it down, which saves the
+ * window and hash table allocations when compressing many small buffers.
+ * Only a change of mem_level between calls reallocates.
+ */
+class deflate_context_t
+{
+  public:
+    explicit deflate_context_t(compress_type_t type);
+    ~deflate_context_t();
+    deflate_context_t(const deflate_context_t&) = delete;
+    deflate_context_t& operator=(const deflate_context_t&) = delete;
+
+    buff_t compress(buff_view_t data, const compress_options_t& options = {});
+
+  private:
+    struct state_t;
+    std::unique_ptr<state_t> state;
+};
+
+/**
+ * @brief An inflate stream kept initialized between calls
+ */
+class inflate_context_t
+{
+  public:
+    explicit inflate_context_t(compress_type_t type);
+    ~inflate_context_t();
+    inflate_context_t(const inflate_context_t&) = delete;
+    inflate_context_t& operator=(const inflate_context_t&) = delete;
+
+    buff_t decompress(buff_view_t data,
+                      std::optional<size_t> fixed_output_size = std::nullopt,
+                      std::optional<size_t> peek_size = std::nullopt);
+    size_t decompress(buff_view_t data, std::span<uint8_t> output);
+    /**
+     * @brief Inflate into output and crc32 it in the same pass
+     * @param crc Receives the crc32 of the inflated data
+     */
+    size_t decompress(buff_view_t data, std::span<uint8_t> output,
+                      uint32_t& crc);
+
+  private:
+    struct state_t;
+    std::unique_ptr<state_t> state;
+};
+
+/**
+ * @brief zstd compression and decompression contexts kept between calls
+ *
+ * Inputs of at least mt_threshold bytes are compressed on several threads
+ * unless a worker count is given. Decompression never needs workers.
+ * Frames made with a dictionary are decoded with the registered dictionary
+ * of the same id, see register_zstd_dictionaries().
+ */
+class zstd_context_t
+{
+  public:
+    static constexpr int default_level = 3;
+    static constexpr size_t mt_threshold = 4 * 1024 * 1024;
+
+    zstd_context_t();
+    ~zstd_context_t();
+    zstd_context_t(const zstd_context_t&) = delete;
+    zstd_context_t& operator=(const zstd_context_t&) = delete;
+
+    /**
+     * @param data The data to compress
+     * @param level The zstd compression level, negative levels are faster
+     * @param workers The number of compression threads, 0 to decide by size
+     * @param dictionary The dictionary to compress with, if any
+     */
+    buff_t compress(buff_view_t data, int level = default_level,
+                    unsigned int workers = 0,
+                    const zstd_dictionary_t* dictionary = nullptr);
+    buff_t decompress(buff_view_t data,
+                      std::optional<size_t> fixed_output_size = std::nullopt,
+                      std::optional<size_t> peek_size = std::nullopt);
+    size_t decompress(buff_view_t data, std::span<uint8_t> output);
+
+  private:
+    struct state_t;
+    std::unique_ptr<state_t> state;
+};
+
+/**
+ * @brief The calling thread's context for a compression type
+ * @note compress() and decompress() use these contexts
+ */
+deflate_context_t& thread_deflate_context(compress_type_t type);
+inflate_context_t& thread_inflate_context(compress_type_t type);
+zstd_context_t& thread_zstd_context();
+
 buff_t compress(const buff_t& data,
                 compress_type_t type);
+/**
+ * @brief Compress with the zstd dictionary registered for a file type
+ * @note Types other than zstd ignore the file type
+ */
+buff_t compress(const buff_t& data,
+                compress_type_t type,
+                file_type_t file_type,
+                const compress_options_t& options = {});
+buff_t compress(const buff_t& data,
+                compress_type_t type,
+                const compress_options_t& options);
 buff_t decompress(const buff_t& data,
                   compress_type_t type,
                   std::optional<size_t> fixed_output_size = std::nullopt,
                   std::optional<size_t> peek_size = std::nullopt);
+
+/**
+ * @brief A cheap guess of how well data would deflate
+ */
+struct compress_estimate_t
+{
+    double entropy;     // order-0 bits per byte of the sampled bytes
+    double match_ratio; // share of sampled bytes repeating earlier ones
+    double ratio;       // predicted compressed size / original size
+};
+
+/**
+ * @brief Estimate compressibility from a few windows spread over the data
+ *
+ * Looks at no more than 64 KiB however large the data is, which makes it
+ * far cheaper than a trial deflate. Meant to catch media payloads (ogg,
+ * BCn textures, sound banks) that would barely shrink.
+ */
+compress_estimate_t estimate_compression(buff_view_t data);
+
+/**
+ * @brief Counters of compress_if_gainful() decisions, safe to share
+ */
+struct compress_stats_t
+{
+    std::atomic<size_t> compressed{0};
+    std::atomic<size_t> stored_estimated{0}; // skipped by the estimate
+    std::atomic<size_t> stored_trial{0};     // compressed, but not enough
+    std::atomic<size_t> input_bytes{0};
+    std::atomic<size_t> output_bytes{0};
+};
+
+/**
+ * @brief Compress only when it pays off
+ * @param data The data to compress
+ * @param type The compression type
+ * @param min_gain The smallest saving worth compressing, as a share of size
+ * @param stats Receives the decision, if given
+ * @return The compressed data, or nullopt to store data uncompressed
+ */
+std::optional<buff_t> compress_if_gainful(buff_view_t data,
+                                          compress_type_t type,
+                                          double min_gain = 0.05,
+                                          compress_stats_t* stats = nullptr,
+                                          const compress_options_t& options = {});
+
+/**
+ * @brief Compress large buffers on several threads
+ *
+ * The input is cut into blocks of block_size bytes which are deflated
+ * independently, each primed with the last 32 KiB of the block before it,
+ * and joined into one ordinary zlib, gzip or raw stream. The output only
+ * depends on the data and block_size, not on the number of threads.
+ * zstd input is handed to zstd's own workers instead.
+ * @note Must not be called from a job running on the same pool
+ */
+buff_t compress_parallel(buff_view_t data,
+                         compress_type_t type,
+                         thread_pool_t& pool = default_thread_pool(),
+                         size_t block_size = 1024 * 1024,
+                         const compress_options_t& options = {});
+
+/**
+ * @brief The settings picked for a file type and how they did
+ */
+struct tuned_options_t
+{
+    compress_options_t options;
+    double ratio;      // compressed size / original size of the samples
+    double ms_per_mib; // compression time per MiB of input
+};
+
+/**
+ * @brief Pick compression settings per file type under a time budget
+ *
+ * Each candidate level, and for deflate a few strategy and mem_level
+ * variants, compresses the samples of every file type. The smallest
+ * output whose speed fits the budget wins, the fastest candidate when
+ * none does. Runs on the calling thread, a few MiB per type is plenty.
+ * @param corpus Sample entries by file type
+ * @param type The compression type
+ * @param budget_ms_per_mib The compression time allowed per MiB of input
+ */
+std::map<file_type_t, tuned_options_t> tune_compression(
+    const std::map<file_type_t, std::vector<buff_t>>& corpus,
+    compress_type_t type, double budget_ms_per_mib);
+
+/**
+ * @brief Inflate straight into a caller-provided buffer
+ *
+ * Meant for entries whose uncompressed size is known up front, e.g. from a
+ * hashfs entry table, so the output can live in a reused scratch buffer,
+ * an arena or a mapped output file without any allocation per entry.
+ * @param data The compressed data
+ * @param output Receives the inflated data
+ * @param type The compression type
+ * @return The number of bytes written to output
+ * @throws exception if the data is invalid or does not fit into output
+ */
+size_t decompress(buff_view_t data, std::span<uint8_t> output,
+                  compress_type_t type);
+
+/**
+ * @brief Inflate into output and crc32 what was inflated
+ *
+ * The crc runs over each piece of output right after inflate wrote it, so
+ * the data is fetched from memory once.
+ * @param crc Receives the crc32 of the inflated data
+ */
+size_t decompress(buff_view_t data, std::span<uint8_t> output,
+                  compress_type_t type, uint32_t& crc);
+
+/**
+ * @brief crc32 using zlib-ng's kernels, picked at runtime for the CPU
+ *        (PCLMULQDQ, VPCLMULQDQ, ARMv8 CRC, ...)
+ */
+uint32_t crc32(buff_view_t data, uint32_t crc = 0);
+
+/**
+ * @brief The raw deflate stream inside a zlib, gzip or raw container
+ * @return A view into data, nothing is copied
+ * @throws exception if the container is malformed
+ */
+buff_view_t deflate_payload(buff_view_t data, compress_type_t type);
+
+/**
+ * @brief Checksums of the uncompressed data, where known
+ */
+struct deflate_checksums_t
+{
+    std::optional<uint32_t> adler32;
+    std::optional<uint32_t> crc32;
+    std::optional<size_t> size;
+};
+
+/**
+ * @brief The checksums stored in a container trailer
+ */
+deflate_checksums_t read_checksums(buff_view_t data, compress_type_t type);
+
+/**
+ * @brief Re-wrap a deflate stream as zlib, gzip or raw without recompressing
+ *
+ * The compressed bytes are copied as they are. A checksum the target needs
+ * comes from known, from the source trailer, or, failing both, from one
+ * streaming inflate pass that never holds more than a 64 KiB chunk.
+ * @param data The compressed data
+ * @param from The container of data
+ * @param to The container to produce
+ * @param known Checksums already known, e.g. from an archive entry table
+ */
+buff_t transcode(buff_view_t data, compress_type_t from, compress_type_t to,
+                 deflate_checksums_t known = {});
+
 void remove_zlib_attr(buff_t& data);
 void remove_gzip_attr(buff_t& data);
 
+/**
+ * @brief Incremental inflate producing bounded output chunks
+ *
+ * Compressed input can be fed in pieces of any size, the inflated data is
+ * handed to a sink in chunks of at most chunk_size bytes.
+ */
+class inflate_stream_t
+{
+  public:
+    using sink_t = std::function<void(buff_view_t)>;
+
+    explicit inflate_stream_t(compress_type_t type,
+                              size_t chunk_size = 256 * 1024);
+    ~inflate_stream_t();
+    inflate_stream_t(const inflate_stream_t&) = delete;
+    inflate_stream_t& operator=(const inflate_stream_t&) = delete;
+
+    /**
+     * @brief Inflate the next piece of compressed input
+     * @param input The compressed bytes
+     * @param sink Receives each inflated chunk, valid only during the call
+     * @return true once the end of the compressed stream has been reached
+     * @throws exception if the input is not a valid stream
+     */
+    bool write(buff_view_t input, const sink_t& sink);
+
+    bool finished() const;
+    size_t total_out() const;
+
+  private:
+    struct state_t;
+    std::unique_ptr<state_t> state;
+};
+
+/**
+ * @brief Inflate a span chunk by chunk with bounded memory
+ * @param span The compressed data
+ * @param type The compression type
+ * @param sink Receives each inflated chunk, valid only during the call
+ * @param chunk_size The size of input and output chunks
+ * @throws exception if the data is invalid or truncated
+ */
+void decompress_stream(const span_t& span, compress_type_t type,
+                       const inflate_stream_t::sink_t& sink,
+                       size_t chunk_size = 256 * 1024);
+
 } // namespace ssharp::util
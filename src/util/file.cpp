@@ -0,0 +1,354 @@
+// Copyright (C) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "file.hpp"
+
+#include <list>
+#include <mutex>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ssharp::util
+{
+
+#ifdef _WIN32
+
+file_t::file_t(const path_t& path) : file_path(path)
+{
+    handle = CreateFileW(path.c_str(), GENERIC_READ,
+                         FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                         OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        handle = nullptr;
+        throw std::ios::failure("failed to open file: " + path.string());
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(handle, &file_size))
+    {
+        CloseHandle(handle);
+        throw std::ios::failure("failed to get file size: " + path.string());
+    }
+    length = static_cast<size_t>(file_size.QuadPart);
+    std::error_code ec;
+    write_time = std::filesystem::last_write_time(path, ec);
+}
+
+file_t::~file_t()
+{
+    if (handle)
+    {
+        CloseHandle(handle);
+    }
+}
+
+void file_t::read_at(uint8_t* out, size_t size, size_t offset) const
+{
+    while (size > 0)
+    {
+        // the offset in OVERLAPPED makes ReadFile positional
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD chunk = size > 0x40000000 ? 0x40000000 : static_cast<DWORD>(size);
+        DWORD read = 0;
+        if (!ReadFile(handle, out, chunk, &read, &overlapped) || read == 0)
+        {
+            throw std::ios::failure("failed to read file: " +
+                                    file_path.string());
+        }
+        out += read;
+        offset += read;
+        size -= read;
+    }
+}
+
+void file_t::advise(size_t, size_t, access_advice_t) const
+{
+    // Windows only takes access hints when a file is opened
+}
+
+output_file_t::output_file_t(const path_t& path) : file_path(path)
+{
+    handle = CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                         CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        handle = nullptr;
+        throw std::ios::failure("failed to create file: " + path.string());
+    }
+}
+
+output_file_t::~output_file_t()
+{
+    if (handle)
+    {
+        CloseHandle(handle);
+    }
+}
+
+void output_file_t::write_at(const uint8_t* data, size_t size,
+                             size_t offset) const
+{
+    while (size > 0)
+    {
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD chunk = size > 0x40000000 ? 0x40000000 : static_cast<DWORD>(size);
+        DWORD written = 0;
+        if (!WriteFile(handle, data, chunk, &written, &overlapped) || written == 0)
+        {
+            throw std::ios::failure("failed to write file: " +
+                                    file_path.string());
+        }
+        data += written;
+        offset += written;
+        size -= written;
+    }
+}
+
+void output_file_t::allocate(size_t size)
+{
+    FILE_ALLOCATION_INFO info{};
+    info.AllocationSize.QuadPart = static_cast<LONGLONG>(size);
+    SetFileInformationByHandle(handle, FileAllocationInfo, &info, sizeof(info));
+}
+
+#else
+
+file_t::file_t(const path_t& path) : file_path(path)
+{
+    fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        throw std::ios::failure("failed to open file: " + path.string());
+    }
+    struct stat st;
+    if (::fstat(fd, &st) == -1)
+    {
+        ::close(fd);
+        throw std::ios::failure("failed to get file size: " + path.string());
+    }
+    length = static_cast<size_t>(st.st_size);
+    std::error_code ec;
+    write_time = std::filesystem::last_write_time(path, ec);
+}
+
+file_t::~file_t()
+{
+    if (fd != -1)
+    {
+        ::close(fd);
+    }
+}
+
+void file_t::read_at(uint8_t* out, size_t size, size_t offset) const
+{
+    while (size > 0)
+    {
+        auto read = ::pread(fd, out, size, static_cast<off_t>(offset));
+        if (read == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        if (read <= 0)
+        {
+            throw std::ios::failure("failed to read file: " +
+                                    file_path.string());
+        }
+        out += read;
+        offset += read;
+        size -= read;
+    }
+}
+
+void file_t::advise(size_t offset, size_t size, access_advice_t advice) const
+{
+#ifdef POSIX_FADV_NORMAL
+    int native_advice = POSIX_FADV_NORMAL;
+    switch (advice)
+    {
+        case access_advice_t::normal:
+            break;
+        case access_advice_t::sequential:
+            native_advice = POSIX_FADV_SEQUENTIAL;
+            break;
+        case access_advice_t::random:
+            native_advice = POSIX_FADV_RANDOM;
+            break;
+        case access_advice_t::will_need:
+            native_advice = POSIX_FADV_WILLNEED;
+            break;
+        case access_advice_t::dont_need:
+            native_advice = POSIX_FADV_DONTNEED;
+            break;
+    }
+    ::posix_fadvise(fd, static_cast<off_t>(offset), static_cast<off_t>(size),
+                    native_advice);
+#else
+    // macOS has no posix_fadvise
+    (void)offset;
+    (void)size;
+    (void)advice;
+#endif
+}
+
+output_file_t::output_file_t(const path_t& path) : file_path(path)
+{
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1)
+    {
+        throw std::ios::failure("failed to create file: " + path.string());
+    }
+}
+
+output_file_t::~output_file_t()
+{
+    if (fd != -1)
+    {
+        ::close(fd);
+    }
+}
+
+void output_file_t::write_at(const uint8_t* data, size_t size,
+                             size_t offset) const
+{
+    while (size > 0)
+    {
+        auto written = ::pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (written == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        if (written <= 0)
+        {
+            throw std::ios::failure("failed to write file: " +
+                                    file_path.string());
+        }
+        data += written;
+        offset += written;
+        size -= written;
+    }
+}
+
+void output_file_t::allocate(size_t size)
+{
+#ifdef __APPLE__
+    // macOS has no posix_fallocate
+    (void)size;
+#else
+    ::posix_fallocate(fd, 0, static_cast<off_t>(size));
+#endif
+}
+
+#endif
+
+bool file_t::is_current() const
+{
+    std::error_code ec;
+    auto size = std::filesystem::file_size(file_path, ec);
+    if (ec || size != length)
+    {
+        return false;
+    }
+    return std::filesystem::last_write_time(file_path, ec) == write_time &&
+           !ec;
+}
+
+namespace
+{
+
+// most recently used entries live at the front of the list
+struct file_cache_t
+{
+    std::mutex mutex;
+    size_t capacity = 64;
+    std::list<std::pair<path_t, file_ptr_t>> entries;
+    std::unordered_map<path_t::string_type,
+                       decltype(entries)::iterator>
+        index;
+
+    void trim()
+    {
+        while (entries.size() > capacity)
+        {
+            index.erase(entries.back().first.native());
+            entries.pop_back();
+        }
+    }
+};
+
+file_cache_t& file_cache()
+{
+    static file_cache_t cache;
+    return cache;
+}
+
+} // namespace
+
+file_ptr_t open_file(const path_t& path, bool revalidate)
+{
+    auto& cache = file_cache();
+    {
+        std::lock_guard lock{cache.mutex};
+        auto it = cache.index.find(path.native());
+        if (it != cache.index.end())
+        {
+            if (!revalidate || it->second->second->is_current())
+            {
+                cache.entries.splice(cache.entries.begin(), cache.entries,
+                                     it->second);
+                return it->second->second;
+            }
+            cache.entries.erase(it->second);
+            cache.index.erase(it);
+        }
+    }
+    // open outside the lock, a racing open of the same path is harmless
+    auto file = std::make_shared<const file_t>(path);
+    std::lock_guard lock{cache.mutex};
+    if (cache.capacity == 0)
+    {
+        return file;
+    }
+    auto it = cache.index.find(path.native());
+    if (it != cache.index.end())
+    {
+        cache.entries.splice(cache.entries.begin(), cache.entries, it->second);
+        return it->second->second;
+    }
+    cache.entries.emplace_front(path, file);
+    cache.index.emplace(path.native(), cache.entries.begin());
+    cache.trim();
+    return file;
+}
+
+void set_file_cache_capacity(size_t capacity)
+{
+    auto& cache = file_cache();
+    std::lock_guard lock{cache.mutex};
+    cache.capacity = capacity;
+    cache.trim();
+}
+
+} // namespace ssharp::util
@@ -0,0 +1,156 @@
+// Copyright (C) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "util/types.hpp"
+
+namespace ssharp::util
+{
+
+using namespace ssharp::types;
+
+/**
+ * @brief A read-only file descriptor that only does positional reads
+ *
+ * read_at() never moves a shared file position, so one file_t can be read
+ * from any number of threads at once without locking.
+ */
+class file_t
+{
+  public:
+    explicit file_t(const path_t& path);
+    ~file_t();
+    file_t(const file_t&) = delete;
+    file_t(file_t&&) = delete;
+    file_t& operator=(const file_t&) = delete;
+    file_t& operator=(file_t&&) = delete;
+
+    /**
+     * @brief Read exactly size bytes at offset into out
+     * @throws std::ios::failure on I/O errors or if the file is too short
+     */
+    void read_at(uint8_t* out, size_t size, size_t offset) const;
+
+    size_t size() const
+    {
+        return length;
+    }
+
+    const path_t& path() const
+    {
+        return file_path;
+    }
+
+    /**
+     * @brief Hint how a range of the file is about to be read
+     * @note dont_need drops the range from the page cache
+     */
+    void advise(size_t offset, size_t size, access_advice_t advice) const;
+
+    /**
+     * @brief Check whether the file on disk still matches this descriptor
+     */
+    bool is_current() const;
+
+#ifdef _WIN32
+    void* native_handle() const
+    {
+        return handle;
+    }
+#else
+    int native_handle() const
+    {
+        return fd;
+    }
+#endif
+
+  private:
+    path_t file_path;
+    size_t length = 0;
+    std::filesystem::file_time_type write_time;
+#ifdef _WIN32
+    void* handle = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+/**
+ * @brief A file created for writing that only does positional writes
+ *
+ * write_at() never moves a shared file position, so disjoint ranges can be
+ * written from any number of threads at once without locking.
+ */
+class output_file_t
+{
+  public:
+    /**
+     * @brief Create the file, or truncate it if it exists
+     * @throws std::ios::failure if the file cannot be created
+     */
+    explicit output_file_t(const path_t& path);
+    ~output_file_t();
+    output_file_t(const output_file_t&) = delete;
+    output_file_t(output_file_t&&) = delete;
+    output_file_t& operator=(const output_file_t&) = delete;
+    output_file_t& operator=(output_file_t&&) = delete;
+
+    /**
+     * @brief Write size bytes of data at offset
+     * @throws std::ios::failure on I/O errors
+     */
+    void write_at(const uint8_t* data, size_t size, size_t offset) const;
+
+    /**
+     * @brief Reserve disk space for the first size bytes up front, so the
+     *        file is not fragmented by writes landing out of order
+     * @note A hint, filesystems that cannot preallocate only grow the file
+     */
+    void allocate(size_t size);
+
+    const path_t& path() const
+    {
+        return file_path;
+    }
+
+  private:
+    path_t file_path;
+#ifdef _WIN32
+    void* handle = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+/**
+ * @brief Open a file through the process-wide descriptor cache
+ *
+ * The cache keeps the most recently used descriptors open, keyed by path.
+ * Evicted descriptors are closed once the last file_ptr_t to them is gone.
+ * @param path The file to open
+ * @param revalidate Reopen the file if it changed on disk since it was
+ *                   cached, costs a stat call
+ * @return A shared handle to the open file
+ * @throws std::ios::failure if the file cannot be opened
+ */
+file_ptr_t open_file(const path_t& path, bool revalidate = false);
+
+/**
+ * @brief Set how many descriptors the cache keeps open
+ * @param capacity The maximum number of cached descriptors, 0 disables
+ *                 caching
+ */
+void set_file_cache_capacity(size_t capacity);
+
+} // namespace ssharp::util
@@ -0,0 +1,44 @@
+// Copyright (C) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "util/types.hpp"
+
+namespace ssharp::util
+{
+
+using namespace ssharp::types;
+
+/**
+ * @brief Guess the file type of a path from its extension
+ * @param path The path to look at
+ * @return The file type, generic for unknown extensions
+ */
+inline file_type_t file_type_of(const path_t& path)
+{
+    auto extension = path.extension().string();
+    if (extension == ".sii")
+        return file_type_t::sii;
+    if (extension == ".mat")
+        return file_type_t::mat;
+    if (extension == ".pmd")
+        return file_type_t::pmd;
+    if (extension == ".tobj")
+        return file_type_t::tobj;
+    if (extension == ".soundref")
+        return file_type_t::soundref;
+    return file_type_t::generic;
+}
+
+} // namespace ssharp::util
@@ -0,0 +1,182 @@
+// Copyright (C) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mapping.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ssharp::util
+{
+
+#ifdef _WIN32
+
+mapping_t::mapping_t(const path_t& path) : file_path(path)
+{
+    file_handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE)
+    {
+        file_handle = nullptr;
+        throw std::ios::failure("failed to open file: " + path.string());
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file_handle, &file_size))
+    {
+        CloseHandle(file_handle);
+        throw std::ios::failure("failed to get file size: " + path.string());
+    }
+    length = static_cast<size_t>(file_size.QuadPart);
+    // CreateFileMapping refuses empty files, an empty span needs no view
+    if (length == 0)
+    {
+        return;
+    }
+    mapping_handle = CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0,
+                                        0, nullptr);
+    if (mapping_handle == nullptr)
+    {
+        CloseHandle(file_handle);
+        throw std::ios::failure("failed to map file: " + path.string());
+    }
+    base = static_cast<const uint8_t*>(
+        MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+    if (base == nullptr)
+    {
+        CloseHandle(mapping_handle);
+        CloseHandle(file_handle);
+        throw std::ios::failure("failed to map file: " + path.string());
+    }
+}
+
+mapping_t::~mapping_t()
+{
+    if (base)
+    {
+        UnmapViewOfFile(base);
+    }
+    if (mapping_handle)
+    {
+        CloseHandle(mapping_handle);
+    }
+    if (file_handle)
+    {
+        CloseHandle(file_handle);
+    }
+}
+
+void mapping_t::advise(size_t offset, size_t size,
+                       access_advice_t advice) const
+{
+    // only prefetching has a Windows counterpart
+    if (base == nullptr || size == 0 || advice != access_advice_t::will_need)
+    {
+        return;
+    }
+    WIN32_MEMORY_RANGE_ENTRY range{const_cast<uint8_t*>(base) + offset, size};
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+#else
+
+mapping_t::mapping_t(const path_t& path) : file_path(path)
+{
+    fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        throw std::ios::failure("failed to open file: " + path.string());
+    }
+    struct stat st;
+    if (::fstat(fd, &st) == -1)
+    {
+        ::close(fd);
+        throw std::ios::failure("failed to get file size: " + path.string());
+    }
+    length = static_cast<size_t>(st.st_size);
+    // mmap refuses zero-length mappings, an empty span needs no pages
+    if (length == 0)
+    {
+        return;
+    }
+    void* addr = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        ::close(fd);
+        throw std::ios::failure("failed to map file: " + path.string());
+    }
+    base = static_cast<const uint8_t*>(addr);
+}
+
+mapping_t::~mapping_t()
+{
+    if (base)
+    {
+        ::munmap(const_cast<uint8_t*>(base), length);
+    }
+    // kept open so dont_need can drop pages from the page cache
+    ::close(fd);
+}
+
+void mapping_t::advise(size_t offset, size_t size,
+                       access_advice_t advice) const
+{
+    if (base == nullptr || size == 0)
+    {
+        return;
+    }
+    // madvise wants a page aligned start
+    static const size_t page_size = ::sysconf(_SC_PAGESIZE);
+    auto aligned = offset & ~(page_size - 1);
+    auto addr = const_cast<uint8_t*>(base) + aligned;
+    size += offset - aligned;
+    switch (advice)
+    {
+        case access_advice_t::normal:
+            ::madvise(addr, size, MADV_NORMAL);
+            break;
+        case access_advice_t::sequential:
+            ::madvise(addr, size, MADV_SEQUENTIAL);
+            break;
+        case access_advice_t::random:
+            ::madvise(addr, size, MADV_RANDOM);
+            break;
+        case access_advice_t::will_need:
+            ::madvise(addr, size, MADV_WILLNEED);
+            break;
+        case access_advice_t::dont_need:
+            ::madvise(addr, size, MADV_DONTNEED);
+#ifdef POSIX_FADV_DONTNEED
+            ::posix_fadvise(fd, static_cast<off_t>(aligned),
+                            static_cast<off_t>(size), POSIX_FADV_DONTNEED);
+#endif
+            break;
+    }
+}
+
+#endif
+
+mapping_ptr_t map_file(const path_t& path)
+{
+    return std::make_shared<const mapping_t>(path);
+}
+
+} // namespace ssharp::util
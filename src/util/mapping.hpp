@@ -0,0 +1,81 @@
+// Copyright (C) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "util/types.hpp"
+
+namespace ssharp::util
+{
+
+using namespace ssharp::types;
+
+/**
+ * @brief A read-only, shared memory mapping of a whole file
+ *
+ * The mapping stays valid for as long as any mapping_ptr_t refers to it, so
+ * spans and sub-spans created from it can hand out pointers into the file
+ * without reopening or reading it.
+ */
+class mapping_t
+{
+  public:
+    explicit mapping_t(const path_t& path);
+    ~mapping_t();
+    mapping_t(const mapping_t&) = delete;
+    mapping_t(mapping_t&&) = delete;
+    mapping_t& operator=(const mapping_t&) = delete;
+    mapping_t& operator=(mapping_t&&) = delete;
+
+    const uint8_t* data() const
+    {
+        return base;
+    }
+
+    size_t size() const
+    {
+        return length;
+    }
+
+    const path_t& path() const
+    {
+        return file_path;
+    }
+
+    /**
+     * @brief Hint how a range of the mapping is about to be accessed
+     * @note dont_need also drops the range from the page cache
+     */
+    void advise(size_t offset, size_t size, access_advice_t advice) const;
+
+  private:
+    path_t file_path;
+    const uint8_t* base = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    void* file_handle = nullptr;
+    void* mapping_handle = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+/**
+ * @brief Map a file into memory
+ * @param path The file to map
+ * @return A shared handle to the mapping
+ * @throws std::ios::failure if the file cannot be opened or mapped
+ */
+mapping_ptr_t map_file(const path_t& path);
+
+} // namespace ssharp::util
@@ -0,0 +1,137 @@
+// Copyright (C) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "read_planner.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace ssharp::util
+{
+
+read_plan_t plan_reads(std::span<const read_request_t> requests,
+                       const read_plan_options_t& options)
+{
+    std::vector<size_t> order(requests.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::sort(order, [&](size_t lhs, size_t rhs) {
+        return static_cast<size_t>(requests[lhs].attr.first) <
+               static_cast<size_t>(requests[rhs].attr.first);
+    });
+
+    read_plan_t plan;
+    for (auto index : order)
+    {
+        auto offset = static_cast<size_t>(requests[index].attr.first);
+        auto size = requests[index].attr.second;
+        if (size == 0)
+        {
+            continue;
+        }
+        if (!plan.empty())
+        {
+            auto& last = plan.back();
+            auto last_end = last.offset + last.size;
+            auto end = std::max(last_end, offset + size);
+            if (offset <= last_end ||
+                (offset - last_end <= options.max_gap &&
+                 end - last.offset <= options.max_read))
+            {
+                last.size = end - last.offset;
+                last.requests.push_back(index);
+                continue;
+            }
+        }
+        plan.push_back({offset, size, {index}});
+    }
+    return plan;
+}
+
+void read_coalesced(const span_t& span,
+                    std::span<const read_request_t> requests,
+                    const read_plan_options_t& options)
+{
+    for (const auto& request : requests)
+    {
+        if (request.out.size() < request.attr.second)
+        {
+            throw ssexcept::span_error("output buffer too small");
+        }
+    }
+    // resident spans gain nothing from merging
+    if (span.view())
+    {
+        read_batch(span, requests);
+        return;
+    }
+
+    auto plan = plan_reads(requests, options);
+    if (!plan.empty() && options.advice != access_advice_t::normal)
+    {
+        auto end = plan.back().offset + plan.back().size;
+        span.advise(options.advice,
+                    span_attr_t{plan.front().offset, end - plan.front().offset});
+    }
+    auto window = std::max<size_t>(options.queue_depth, 1);
+    std::vector<buff_t> scratch;
+    std::vector<read_request_t> batch;
+    for (size_t first = 0; first < plan.size(); first += window)
+    {
+        auto last = std::min(first + window, plan.size());
+        scratch.resize(last - first);
+        batch.clear();
+        for (auto i = first; i < last; i++)
+        {
+            const auto& read = plan[i];
+            span_attr_t attr{read.offset, read.size};
+            // a read that was not merged goes straight to its destination
+            if (read.requests.size() == 1)
+            {
+                batch.push_back({attr, requests[read.requests.front()].out});
+                continue;
+            }
+            auto& buff = scratch[i - first];
+            buff.resize(read.size);
+            batch.push_back({attr, buff});
+        }
+        read_batch(span, batch, window);
+        for (auto i = first; i < last; i++)
+        {
+            const auto& read = plan[i];
+            if (read.requests.size() == 1)
+            {
+                continue;
+            }
+            const auto& buff = scratch[i - first];
+            for (auto index : read.requests)
+            {
+                const auto& request = requests[index];
+                auto begin = buff.begin() +
+                             (static_cast<size_t>(request.attr.first) -
+                              read.offset);
+                std::copy(begin, begin + request.attr.second,
+                          request.out.begin());
+            }
+        }
+        if (options.drop_behind)
+        {
+            for (auto i = first; i < last; i++)
+            {
+                span.advise(access_advice_t::dont_need,
+                            span_attr_t{plan[i].offset, plan[i].size});
+            }
+        }
+    }
+}
+
+} // namespace ssharp::util
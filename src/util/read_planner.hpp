@@ -0,0 +1,72 @@
+// Copyright (C) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "util/batch_read.hpp"
+#include "util/types.hpp"
+
+namespace ssharp::util
+{
+
+using namespace ssharp::types;
+
+struct read_plan_options_t
+{
+    size_t max_gap = 64 * 1024;         // largest hole worth reading through
+    size_t max_read = 16 * 1024 * 1024; // largest merged read
+    size_t queue_depth = 16;            // merged reads in flight at once
+    access_advice_t advice = access_advice_t::normal; // for the whole scan
+    bool drop_behind = false; // drop merged reads from the page cache
+};
+
+struct planned_read_t
+{
+    size_t offset;
+    size_t size;
+    std::vector<size_t> requests; // indices into the planned requests
+};
+
+using read_plan_t = std::vector<planned_read_t>;
+
+/**
+ * @brief Sort requests by offset and merge neighbours into larger reads
+ *
+ * Two requests end up in the same read when the hole between them is at
+ * most max_gap bytes and the merged read stays within max_read bytes.
+ * Overlapping requests are always merged.
+ * @param requests The reads to plan
+ * @param options The merge thresholds
+ * @return The merged reads in ascending offset order
+ */
+read_plan_t plan_reads(std::span<const read_request_t> requests,
+                       const read_plan_options_t& options = {});
+
+/**
+ * @brief Read many ranges of a span as few large sequential reads
+ *
+ * Reads are issued in offset order and sliced back into each request's
+ * buffer, so a whole-archive scan in hash order reads the file front to
+ * back. Entry spans of an archive are addressed relative to the archive
+ * span, i.e. entry.offset() - archive.offset().
+ * @param span The span to read from
+ * @param requests The ranges to read and where to put them
+ * @param options The merge thresholds
+ * @throws span_error if a range is out of bounds or its buffer is too small
+ * @throws std::ios::failure on I/O errors
+ */
+void read_coalesced(const span_t& span,
+                    std::span<const read_request_t> requests,
+                    const read_plan_options_t& options = {});
+
+} // namespace ssharp::util
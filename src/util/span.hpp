@@ -14,9 +14,12 @@
 #pragma once
 
 #include "util/exceptions.hpp"
+#include "util/file.hpp"
+#include "util/mapping.hpp"
 #include "util/types.hpp"
 
 #include <concepts>
+#include <cstring>
 #include <expected>
 
 namespace ssharp::util
@@ -27,10 +30,13 @@ namespace ssexcept = ssharp::exceptions;
 
 template <typename t>
 concept span_source_t_c = std::same_as<t, buff_t> || std::same_as<t, path_t> ||
+                          std::same_as<t, shared_buff_t> ||
+                          std::same_as<t, file_ptr_t> ||
+                          std::same_as<t, mapping_ptr_t> ||
                           std::same_as<t, span_source_t>;
 
 template <typename t>
-concept buff_t_c = std::same_as<t, buff_t>;
+concept buff_t_c = std::same_as<std::remove_cvref_t<t>, buff_t>;
 
 class span_t
 {
@@ -42,40 +48,68 @@ class span_t
     span_t& operator=(span_t&&) = default;
 
     template <buff_t_c buff_t_t>
-    span_t(buff_t_t&& buff, std::optional<span_attr_t> attr = std::nullopt)
+    span_t(buff_t_t&& buff, std::optional<span_attr_t> attr = std::nullopt) :
+        span_t(std::make_shared<const buff_t>(std::forward<buff_t_t>(buff)),
+               attr)
     {
-        if (attr && attr->first + attr->second > buff.size())
+    }
+
+    span_t(shared_buff_t buff, std::optional<span_attr_t> attr = std::nullopt)
+    {
+        if (!buff)
+        {
+            throw ssexcept::span_error("Invalid span source");
+        }
+        auto [pos, size] = attr.value_or(std::make_pair(0, buff->size()));
+        auto u_pos = static_cast<size_t>(pos);
+        if (u_pos + size > buff->size())
         {
             throw ssexcept::span_error("out of range");
         }
-        source = std::forward<buff_t_t>(buff);
-        this->attr = attr.value_or(std::make_pair(0, buff.size()));
+        source = std::move(buff);
+        this->attr = std::make_pair(u_pos, size);
+    }
+
+    span_t(const path_t& path, std::optional<span_attr_t> attr = std::nullopt) :
+        span_t(open_file(path, true), attr)
+    {
     }
 
-    span_t(const path_t& path, std::optional<span_attr_t> attr = std::nullopt)
+    span_t(file_ptr_t file, std::optional<span_attr_t> attr = std::nullopt)
     {
-        std::ifstream file(path, std::ios::binary);
-        if (!file.is_open())
+        if (!file)
         {
-            throw std::ios::failure("failed to open file: " + path.string());
+            throw ssexcept::span_error("Invalid span source");
+        }
+        auto [pos, size] = attr.value_or(std::make_pair(0, file->size()));
+        auto u_pos = static_cast<size_t>(pos);
+        if (u_pos + size > file->size())
+        {
+            throw ssexcept::span_error("out of range");
         }
-        file.seekg(0, std::ios::end);
-        auto total_size = file.tellg();
-        if (total_size == -1)
+        // the descriptor is resolved once here, reads never go through the
+        // cache and its lock again
+        source = std::move(file);
+        this->attr = std::make_pair(u_pos, size);
+    }
+
+    span_t(mapping_ptr_t mapping,
+           std::optional<span_attr_t> attr = std::nullopt)
+    {
+        if (!mapping)
         {
-            throw std::ios::failure("failed to get file size: " + path.string());
+            throw ssexcept::span_error("Invalid span source");
         }
-        auto [pos, size] = attr.value_or(std::make_pair(0, total_size));
+        auto [pos, size] = attr.value_or(std::make_pair(0, mapping->size()));
         auto u_pos = static_cast<size_t>(pos);
-        auto u_total_size = static_cast<size_t>(total_size);
-        if (u_pos + size > u_total_size)
+        if (u_pos + size > mapping->size())
         {
             throw ssexcept::span_error("out of range");
         }
-        source = path;
+        source = std::move(mapping);
         this->attr = std::make_pair(u_pos, size);
     }
-    
+
     span_t(const span_t& span, span_attr_t attr)
     {
         auto [span_pos, span_size] = span.attr;
@@ -84,20 +118,9 @@ class span_t
         {
             throw ssexcept::span_error("out of range");
         }
-        if (std::holds_alternative<buff_t>(span.source))
-        {
-            auto& buff_ref = std::get<buff_t>(span.source);
-            auto buff = buff_t(buff_ref.begin() + span_pos + pos,
-                               buff_ref.begin() + span_pos + pos + size);
-            this->source = buff;
-            this->attr = {0, size};
-        }
-        else if (std::holds_alternative<path_t>(span.source))
-        {
-            this->source = span.source;
-            this->attr = {span_pos + pos, size};
-        }
-        throw ssexcept::span_error("Invalid span source");
+        // every source is shared, a sub-span only narrows the range
+        this->source = span.source;
+        this->attr = {span_pos + pos, size};
     }
 
     buff_t operator*() const
@@ -118,34 +141,126 @@ class span_t
             eventual_pos += pos;
             eventual_size = size;
         }
-        if (std::holds_alternative<buff_t>(source))
+        if (std::holds_alternative<shared_buff_t>(source))
         {
-            auto& buff = std::get<buff_t>(source);
+            auto& buff = *std::get<shared_buff_t>(source);
             return buff_t(buff.begin() + eventual_pos,
                           buff.begin() + eventual_pos + eventual_size);
         }
-        else if (std::holds_alternative<path_t>(source))
+        else if (std::holds_alternative<file_ptr_t>(source))
         {
-            const auto& path = std::get<path_t>(source);
-            std::ifstream file(path, std::ios::binary);
-            if (!file.is_open())
-            {
-                throw std::ios::failure(
-                    "Failed to open file: " + path.string());
-            }
-            file.seekg(eventual_pos);
+            // positional read through the shared descriptor, safe to call
+            // from any number of threads
+            const auto& file = std::get<file_ptr_t>(source);
             buff_t buff(eventual_size);
-            file.read(reinterpret_cast<char*>(buff.data()), buff.size());
+            file->read_at(buff.data(), buff.size(),
+                          static_cast<size_t>(eventual_pos));
             return buff;
         }
+        else if (std::holds_alternative<mapping_ptr_t>(source))
+        {
+            auto data = std::get<mapping_ptr_t>(source)->data() +
+                        static_cast<size_t>(eventual_pos);
+            return buff_t(data, data + eventual_size);
+        }
         throw ssexcept::span_error("Invalid span source");
     }
 
+    /**
+     * @brief Borrow the bytes of the span without copying them
+     * @param part The range to borrow, relative to the span
+     * @return A view into the source, or std::nullopt if the source is not
+     *         resident in memory
+     * @note The view is valid while this span or a span sharing its source
+     *       is alive
+     */
+    std::optional<buff_view_t> view(
+        std::optional<span_attr_t> part = std::nullopt) const
+    {
+        auto [eventual_pos, eventual_size] = attr;
+        if (part)
+        {
+            auto [pos, size] = *part;
+            if (static_cast<size_t>(pos) + size > eventual_size)
+            {
+                throw ssexcept::span_error("Out of range error");
+            }
+            eventual_pos += pos;
+            eventual_size = size;
+        }
+        if (std::holds_alternative<shared_buff_t>(source))
+        {
+            return buff_view_t{std::get<shared_buff_t>(source)->data() +
+                                   static_cast<size_t>(eventual_pos),
+                               eventual_size};
+        }
+        else if (std::holds_alternative<mapping_ptr_t>(source))
+        {
+            return buff_view_t{std::get<mapping_ptr_t>(source)->data() +
+                                   static_cast<size_t>(eventual_pos),
+                               eventual_size};
+        }
+        return std::nullopt;
+    }
+
     size_t size() const
     {
         return attr.second;
     }
 
+    /**
+     * @brief Tell the kernel how the span is about to be accessed
+     * @param advice The expected access pattern
+     * @param part The range the advice applies to, relative to the span
+     * @note Only a hint, buffer-backed spans ignore it
+     */
+    void advise(access_advice_t advice,
+                std::optional<span_attr_t> part = std::nullopt) const
+    {
+        auto [eventual_pos, eventual_size] = attr;
+        if (part)
+        {
+            auto [pos, size] = *part;
+            if (static_cast<size_t>(pos) + size > eventual_size)
+            {
+                throw ssexcept::span_error("Out of range error");
+            }
+            eventual_pos += pos;
+            eventual_size = size;
+        }
+        if (std::holds_alternative<mapping_ptr_t>(source))
+        {
+            std::get<mapping_ptr_t>(source)->advise(
+                static_cast<size_t>(eventual_pos), eventual_size, advice);
+        }
+        else if (std::holds_alternative<file_ptr_t>(source))
+        {
+            std::get<file_ptr_t>(source)->advise(
+                static_cast<size_t>(eventual_pos), eventual_size, advice);
+        }
+    }
+
+    /**
+     * @brief The position of the span within its source
+     */
+    size_t offset() const
+    {
+        return static_cast<size_t>(attr.first);
+    }
+
+    /**
+     * @brief The open file behind a path-backed span
+     * @return The file, or nullptr if the span is not backed by a path
+     */
+    file_ptr_t file() const
+    {
+        if (std::holds_alternative<file_ptr_t>(source))
+        {
+            return std::get<file_ptr_t>(source);
+        }
+        return nullptr;
+    }
+
   private:
     span_source_t source;
     span_attr_t attr;
@@ -0,0 +1,141 @@
+// Copyright (C) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+namespace ssharp::util
+{
+
+namespace
+{
+thread_local const thread_pool_t* current_pool = nullptr;
+} // namespace
+
+thread_pool_t::thread_pool_t(size_t threads)
+{
+    if (threads == 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; i++)
+    {
+        workers.emplace_back([this]() { work(); });
+    }
+}
+
+thread_pool_t::~thread_pool_t()
+{
+    {
+        std::lock_guard lock{mutex};
+        stopping = true;
+    }
+    condition.notify_all();
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void thread_pool_t::push(std::function<void()> job)
+{
+    {
+        std::lock_guard lock{mutex};
+        jobs.push_back(std::move(job));
+    }
+    condition.notify_one();
+}
+
+void thread_pool_t::work()
+{
+    current_pool = this;
+    while (true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock lock{mutex};
+            condition.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (jobs.empty())
+            {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        job();
+    }
+}
+
+void thread_pool_t::parallel_for(size_t count,
+                                 const std::function<void(size_t)>& fn)
+{
+    std::atomic<size_t> next = 0;
+    std::atomic<bool> failed = false;
+    auto drain = [&]() {
+        for (auto i = next++; i < count && !failed; i = next++)
+        {
+            try
+            {
+                fn(i);
+            }
+            catch (...)
+            {
+                failed = true;
+                throw;
+            }
+        }
+    };
+    std::vector<std::future<void>> futures;
+    auto helpers = std::min(count, size());
+    futures.reserve(helpers);
+    for (size_t i = 0; i < helpers; i++)
+    {
+        futures.push_back(submit(drain));
+    }
+    // wait for every helper before rethrowing, they reference this frame
+    std::exception_ptr error;
+    for (auto& future : futures)
+    {
+        try
+        {
+            future.get();
+        }
+        catch (...)
+        {
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+        }
+    }
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+bool thread_pool_t::is_worker() const
+{
+    return current_pool == this;
+}
+
+thread_pool_t& default_thread_pool()
+{
+    static thread_pool_t pool;
+    return pool;
+}
+
+} // namespace ssharp::util
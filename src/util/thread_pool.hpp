@@ -0,0 +1,84 @@
+// Copyright (C) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace ssharp::util
+{
+
+/**
+ * @brief A fixed set of worker threads draining a shared job queue
+ */
+class thread_pool_t
+{
+  public:
+    explicit thread_pool_t(size_t threads = 0);
+    ~thread_pool_t();
+    thread_pool_t(const thread_pool_t&) = delete;
+    thread_pool_t& operator=(const thread_pool_t&) = delete;
+
+    template <typename fn_t>
+    auto submit(fn_t&& fn) -> std::future<std::invoke_result_t<fn_t>>
+    {
+        using result_t = std::invoke_result_t<fn_t>;
+        auto task = std::make_shared<std::packaged_task<result_t()>>(
+            std::forward<fn_t>(fn));
+        auto future = task->get_future();
+        push([task]() { (*task)(); });
+        return future;
+    }
+
+    /**
+     * @brief Run fn(i) for every i in [0, count) on the pool and wait
+     * @throws The first exception thrown by fn, after all work has stopped
+     * @note Must not be called from a job running on the same pool
+     */
+    void parallel_for(size_t count, const std::function<void(size_t)>& fn);
+
+    size_t size() const
+    {
+        return workers.size();
+    }
+
+    /**
+     * @brief Whether the calling thread is one of this pool's workers, in
+     *        which case it must not wait on the pool
+     */
+    bool is_worker() const;
+
+  private:
+    void push(std::function<void()> job);
+    void work();
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<std::function<void()>> jobs;
+    bool stopping = false;
+};
+
+/**
+ * @brief The process-wide pool, sized to the number of hardware threads
+ */
+thread_pool_t& default_thread_pool();
+
+} // namespace ssharp::util
@@ -16,7 +16,10 @@
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <set>
+#include <span>
 #include <sstream>
 #include <string>
 #include <tuple>
@@ -24,14 +27,24 @@
 #include <vector>
 #include <unordered_map>
 
+namespace ssharp::util
+{
+class file_t;
+class mapping_t;
+} // namespace ssharp::util
+
 namespace ssharp::types
 {
 
 using buff_t = std::vector<uint8_t>;
+using buff_view_t = std::span<const uint8_t>;
+using shared_buff_t = std::shared_ptr<const buff_t>;
 using path_t = std::filesystem::path;
 using paths_t = std::set<path_t>;
 using pos_t = std::streampos;
-using span_source_t = std::variant<buff_t, path_t>;
+using file_ptr_t = std::shared_ptr<const ssharp::util::file_t>;
+using mapping_ptr_t = std::shared_ptr<const ssharp::util::mapping_t>;
+using span_source_t = std::variant<shared_buff_t, file_ptr_t, mapping_ptr_t>;
 using span_attr_t = std::pair<pos_t, size_t>;
 using hash_t = uint64_t;
 using salt_t = uint16_t;
@@ -56,6 +69,15 @@ enum class compress_type_t
     zstd = 4
 };
 
+enum class access_advice_t
+{
+    normal,
+    sequential,
+    random,
+    will_need,
+    dont_need
+};
+
 enum class is_directory_t
 {
     file,
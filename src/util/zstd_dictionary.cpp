@@ -0,0 +1,232 @@
+// Copyright (C) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "zstd_dictionary.hpp"
+
+#include <fstream>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "zstd.h"
+#include "zdict.h"
+
+namespace ssharp::util
+{
+namespace ssexcept = ssharp::exceptions;
+
+zstd_dictionary_t::zstd_dictionary_t(buff_t content) : dict(std::move(content))
+{
+    dict_id = ZDICT_getDictID(dict.data(), dict.size());
+    if (dict_id == 0)
+    {
+        throw ssexcept::exception("Invalid zstd dictionary");
+    }
+    decoder = ZSTD_createDDict(dict.data(), dict.size());
+    if (decoder == nullptr)
+    {
+        throw ssexcept::exception("Failed to load zstd dictionary");
+    }
+}
+
+zstd_dictionary_t::~zstd_dictionary_t()
+{
+    for (auto& [level, encoder] : encoders)
+    {
+        ZSTD_freeCDict(encoder);
+    }
+    ZSTD_freeDDict(decoder);
+}
+
+const ZSTD_CDict_s* zstd_dictionary_t::cdict(int level) const
+{
+    std::lock_guard lock(mutex);
+    auto& encoder = encoders[level];
+    if (encoder == nullptr)
+    {
+        encoder = ZSTD_createCDict(dict.data(), dict.size(), level);
+        if (encoder == nullptr)
+        {
+            encoders.erase(level);
+            throw ssexcept::exception("Failed to load zstd dictionary");
+        }
+    }
+    return encoder;
+}
+
+zstd_dictionary_ptr_t train_zstd_dictionary(std::span<const buff_t> samples,
+                                            size_t capacity)
+{
+    buff_t joined;
+    std::vector<size_t> sizes;
+    sizes.reserve(samples.size());
+    for (const auto& sample : samples)
+    {
+        joined.insert(joined.end(), sample.begin(), sample.end());
+        sizes.push_back(sample.size());
+    }
+    buff_t dict(capacity);
+    auto size = ZDICT_trainFromBuffer(dict.data(), dict.size(), joined.data(),
+                                      sizes.data(),
+                                      static_cast<unsigned>(sizes.size()));
+    if (ZDICT_isError(size))
+    {
+        throw ssexcept::exception(
+            std::string{"Failed to train zstd dictionary: "} +
+            ZDICT_getErrorName(size));
+    }
+    dict.resize(size);
+    return std::make_shared<const zstd_dictionary_t>(std::move(dict));
+}
+
+zstd_dictionaries_t train_zstd_dictionaries(
+    const std::map<file_type_t, std::vector<buff_t>>& corpus, size_t capacity)
+{
+    zstd_dictionaries_t dictionaries;
+    for (const auto& [file_type, samples] : corpus)
+    {
+        try
+        {
+            dictionaries[file_type] = train_zstd_dictionary(samples, capacity);
+        }
+        catch (const ssexcept::exception&)
+        {
+            // too few or too uniform samples, entries of this type go
+            // without a dictionary
+        }
+    }
+    return dictionaries;
+}
+
+void save_zstd_dictionaries(const zstd_dictionaries_t& dictionaries,
+                            const path_t& path)
+{
+    std::ofstream ofs(path, std::ios::binary);
+    if (!ofs)
+    {
+        throw std::ios::failure("failed to open file: " + path.string());
+    }
+    zstd_dictionaries_header_t header{zstd_dictionaries_signature,
+                                      zstd_dictionaries_version,
+                                      static_cast<uint32_t>(dictionaries.size())};
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const auto& [file_type, dictionary] : dictionaries)
+    {
+        const auto& content = dictionary->content();
+        zstd_dictionary_entry_t entry{static_cast<uint32_t>(file_type),
+                                      static_cast<uint32_t>(content.size())};
+        ofs.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+        ofs.write(reinterpret_cast<const char*>(content.data()),
+                  content.size());
+    }
+    if (!ofs)
+    {
+        throw std::ios::failure("failed to write file: " + path.string());
+    }
+}
+
+zstd_dictionaries_t load_zstd_dictionaries(const path_t& path)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs)
+    {
+        throw std::ios::failure("failed to open file: " + path.string());
+    }
+    zstd_dictionaries_header_t header{};
+    ifs.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!ifs || header.signature != zstd_dictionaries_signature)
+    {
+        throw ssexcept::parse_error("Invalid zstd dictionaries file");
+    }
+    if (header.version != zstd_dictionaries_version)
+    {
+        throw ssexcept::parse_error("Unsupported zstd dictionaries version");
+    }
+    std::error_code ec;
+    auto file_size = std::filesystem::file_size(path, ec);
+    if (ec)
+    {
+        throw std::ios::failure("failed to get file size: " + path.string());
+    }
+    // the header was read, so the file is at least that long
+    auto remaining = file_size - sizeof(header);
+    zstd_dictionaries_t dictionaries;
+    for (uint32_t i = 0; i < header.count; i++)
+    {
+        zstd_dictionary_entry_t entry{};
+        ifs.read(reinterpret_cast<char*>(&entry), sizeof(entry));
+        // check the claimed size before allocating it
+        if (!ifs || remaining < sizeof(entry) ||
+            entry.size > remaining - sizeof(entry))
+        {
+            throw ssexcept::parse_error("Truncated zstd dictionaries file");
+        }
+        remaining -= sizeof(entry) + entry.size;
+        buff_t content(entry.size);
+        ifs.read(reinterpret_cast<char*>(content.data()), content.size());
+        if (!ifs)
+        {
+            throw ssexcept::parse_error("Truncated zstd dictionaries file");
+        }
+        dictionaries[static_cast<file_type_t>(entry.file_type)] =
+            std::make_shared<const zstd_dictionary_t>(std::move(content));
+    }
+    return dictionaries;
+}
+
+namespace
+{
+
+struct registry_t
+{
+    std::shared_mutex mutex;
+    zstd_dictionaries_t by_type;
+    std::unordered_map<uint32_t, zstd_dictionary_ptr_t> by_id;
+};
+
+registry_t& registry()
+{
+    static registry_t instance;
+    return instance;
+}
+
+} // namespace
+
+void register_zstd_dictionaries(const zstd_dictionaries_t& dictionaries)
+{
+    auto& reg = registry();
+    std::unique_lock lock(reg.mutex);
+    for (const auto& [file_type, dictionary] : dictionaries)
+    {
+        reg.by_type[file_type] = dictionary;
+        // frames made with a replaced dictionary stay decodable
+        reg.by_id[dictionary->id()] = dictionary;
+    }
+}
+
+zstd_dictionary_ptr_t find_zstd_dictionary(file_type_t file_type)
+{
+    auto& reg = registry();
+    std::shared_lock lock(reg.mutex);
+    auto it = reg.by_type.find(file_type);
+    return it == reg.by_type.end() ? nullptr : it->second;
+}
+
+zstd_dictionary_ptr_t find_zstd_dictionary(uint32_t id)
+{
+    auto& reg = registry();
+    std::shared_lock lock(reg.mutex);
+    auto it = reg.by_id.find(id);
+    return it == reg.by_id.end() ? nullptr : it->second;
+}
+
+} // namespace ssharp::util
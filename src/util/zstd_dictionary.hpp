@@ -0,0 +1,131 @@
+// Copyright (C) 2025 TLExpress.
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "util/exceptions.hpp"
+#include "util/types.hpp"
+
+#include <map>
+#include <mutex>
+
+// keeps zstd.h out of this header
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+
+namespace ssharp::util
+{
+
+using namespace ssharp::types;
+
+constexpr uint32_t zstd_dictionaries_signature = 0x445A5353U; // "SSZD"
+constexpr uint32_t zstd_dictionaries_version = 0x01;
+
+#pragma pack(push, 1)
+struct zstd_dictionaries_header_t
+{
+    uint32_t signature;
+    uint32_t version;
+    uint32_t count;
+};
+static_assert(sizeof(zstd_dictionaries_header_t) == 12,
+              "zstd_dictionaries_header_t size mismatch");
+
+struct zstd_dictionary_entry_t
+{
+    uint32_t file_type;
+    uint32_t size;
+    // dictionary content (variable size)
+};
+static_assert(sizeof(zstd_dictionary_entry_t) == 8,
+              "zstd_dictionary_entry_t size mismatch");
+#pragma pack(pop)
+
+/**
+ * @brief A trained zstd dictionary with its digested forms
+ *
+ * Digesting a dictionary costs far more than compressing a small entry, so
+ * the decoder form is built once and encoder forms once per level.
+ */
+class zstd_dictionary_t
+{
+  public:
+    explicit zstd_dictionary_t(buff_t content);
+    ~zstd_dictionary_t();
+    zstd_dictionary_t(const zstd_dictionary_t&) = delete;
+    zstd_dictionary_t& operator=(const zstd_dictionary_t&) = delete;
+
+    uint32_t id() const
+    {
+        return dict_id;
+    }
+
+    const buff_t& content() const
+    {
+        return dict;
+    }
+
+    const ZSTD_CDict_s* cdict(int level) const;
+    const ZSTD_DDict_s* ddict() const
+    {
+        return decoder;
+    }
+
+  private:
+    buff_t dict;
+    uint32_t dict_id;
+    ZSTD_DDict_s* decoder = nullptr;
+    mutable std::mutex mutex;
+    mutable std::map<int, ZSTD_CDict_s*> encoders;
+};
+
+using zstd_dictionary_ptr_t = std::shared_ptr<const zstd_dictionary_t>;
+using zstd_dictionaries_t = std::map<file_type_t, zstd_dictionary_ptr_t>;
+
+/**
+ * @brief Train a dictionary from sample payloads
+ * @param samples Typical payloads, ideally hundreds of them
+ * @param capacity The maximum dictionary size
+ * @return The trained dictionary
+ * @throws exception if zstd cannot train on the samples
+ */
+zstd_dictionary_ptr_t train_zstd_dictionary(std::span<const buff_t> samples,
+                                            size_t capacity = 112640);
+
+/**
+ * @brief Train one dictionary per file type
+ * @note File types with too few samples to train on are skipped
+ */
+zstd_dictionaries_t train_zstd_dictionaries(
+    const std::map<file_type_t, std::vector<buff_t>>& corpus,
+    size_t capacity = 112640);
+
+void save_zstd_dictionaries(const zstd_dictionaries_t& dictionaries,
+                            const path_t& path);
+
+/**
+ * @throws parse_error if the file is not a dictionary set
+ */
+zstd_dictionaries_t load_zstd_dictionaries(const path_t& path);
+
+/**
+ * @brief Make dictionaries available to compress() and decompress()
+ *
+ * compress() with a file type uses the dictionary registered for it, and
+ * decompress() finds the dictionary a frame was made with by its id.
+ */
+void register_zstd_dictionaries(const zstd_dictionaries_t& dictionaries);
+zstd_dictionary_ptr_t find_zstd_dictionary(file_type_t file_type);
+zstd_dictionary_ptr_t find_zstd_dictionary(uint32_t id);
+
+} // namespace ssharp::util